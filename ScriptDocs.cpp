@@ -2,6 +2,17 @@
 
 #include <angelscript.h>
 
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 static void strSplit(const std::string &s, char delim, std::vector<std::string> &elems)
 {
 	std::stringstream ss(s);
@@ -11,24 +22,192 @@ static void strSplit(const std::string &s, char delim, std::vector<std::string>
 	}
 }
 
-ScriptDocs::ScriptDocs(asIScriptEngine* engine)
+static bool wildcardMatch(const char* pattern, const char* str)
+{
+	// Supports '*' for any sequence of characters and '?' for any single character
+	const char* starPattern = nullptr;
+	const char* starStr = nullptr;
+	while (*str != '\0')
+	{
+		if (*pattern == '*')
+		{
+			starPattern = ++pattern;
+			starStr = str;
+		}
+		else if (*pattern == '?' || *pattern == *str)
+		{
+			pattern++;
+			str++;
+		}
+		else if (starPattern != nullptr)
+		{
+			pattern = starPattern;
+			str = ++starStr;
+		}
+		else
+			return false;
+	}
+	while (*pattern == '*')
+		pattern++;
+	return *pattern == '\0';
+}
+
+static std::string xmlEscape(const std::string &s)
+{
+	std::string ret;
+	for (char c : s)
+	{
+		switch (c)
+		{
+		case '&': ret += "&amp;"; break;
+		case '<': ret += "&lt;"; break;
+		case '>': ret += "&gt;"; break;
+		case '"': ret += "&quot;"; break;
+		default: ret += c; break;
+		}
+	}
+	return ret;
+}
+
+static std::string doxygenEscape(const std::string &s, bool caseSensitive)
+{
+	// Same escaping Doxygen uses for its output filenames, where CASE_SENSE_NAMES = NO turns "A" into "_a"
+	std::string ret;
+	for (char c : s)
+	{
+		switch (c)
+		{
+		case '_': ret += "__"; break;
+		case ':': ret += "_1"; break;
+		case '/': ret += "_2"; break;
+		case '<': ret += "_3"; break;
+		case '>': ret += "_4"; break;
+		case '*': ret += "_5"; break;
+		case '&': ret += "_6"; break;
+		case '.': ret += "_8"; break;
+		case ',': ret += "_00"; break;
+		case ' ': ret += "_01"; break;
+		default:
+			if (!caseSensitive && ::isupper((unsigned char)c))
+			{
+				ret += '_';
+				ret += (char)::tolower((unsigned char)c);
+			}
+			else
+				ret += c;
+			break;
+		}
+	}
+	return ret;
+}
+
+static std::string doxygenTemplateName(const std::string &s)
+{
+	// Doxygen spells template instances with spaces inside the brackets, eg: "array< int >", "dictionary< string, int >"
+	std::string ret;
+	for (char c : s)
+	{
+		if (c == '>')
+			ret += ' ';
+		ret += c;
+		if (c == '<')
+			ret += ' ';
+	}
+	return ret;
+}
+
+static unsigned long long hashString(const char* str)
+{
+	// FNV-1a, so hashes stay the same between runs and compilers
+	unsigned long long hash = 14695981039346656037ULL;
+	for (; *str != '\0'; str++)
+	{
+		hash ^= (unsigned char)*str;
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+ScriptDocs::ScriptDocs(asIScriptEngine* engine, const char* name)
 {
 	m_engine = engine;
-	m_stringType = m_engine->GetTypeInfoByDecl("string");
 	m_indent = 0;
+	SetWriteEngine(engine);
+	AddEngine(engine, name);
 }
 
 ScriptDocs::~ScriptDocs()
 {
 }
 
+bool ScriptDocs::AddEngine(asIScriptEngine* engine, const char* name)
+{
+	// Availability is tracked as a bit per engine
+	assert(m_engines.size() < 64);
+	if (m_engines.size() >= 64)
+		return false;
+
+	m_engines.push_back(engine);
+	m_engineNames.push_back(name == nullptr ? "default" : name);
+	return true;
+}
+
+void ScriptDocs::IncludeNamespace(const char* ns)
+{
+	m_includeNamespaces.push_back(ns);
+}
+
+void ScriptDocs::ExcludeNamespace(const char* ns)
+{
+	m_excludeNamespaces.push_back(ns);
+}
+
+void ScriptDocs::IncludeGroup(const char* group)
+{
+	m_includeGroups.push_back(group);
+}
+
+void ScriptDocs::ExcludeGroup(const char* group)
+{
+	m_excludeGroups.push_back(group);
+}
+
+void ScriptDocs::IncludeName(const char* pattern)
+{
+	m_includeNames.push_back(pattern);
+}
+
+void ScriptDocs::ExcludeName(const char* pattern)
+{
+	m_excludeNames.push_back(pattern);
+}
+
+void ScriptDocs::SetFilter(const ScriptDocsFilter &filter)
+{
+	m_filter = filter;
+}
+
+void ScriptDocs::SetTagFile(const char* filename, bool caseSensitiveNames)
+{
+	m_tagFilename = filename;
+	m_tagCaseSensitive = caseSensitiveNames;
+}
+
 void ScriptDocs::Write(const char* filename, bool scripts)
 {
+	Prepare();
+
 	m_stream.open(filename, std::ofstream::out);
 	m_stream << "// Auto-generated engine docs" << std::endl << std::endl;
 	m_stream << "typedef void AnyType;" << std::endl << std::endl;
-	WriteFor(m_engine);
+	if (m_tagFilename != "")
+		BeginTagFile(filename);
+	for (auto engine : m_engines)
+		WriteFor(engine);
+	if (IsTagging())
+		EndTagFile();
 	m_stream.close();
+	SetWriteEngine(m_engine);
 
 	if (scripts)
 	{
@@ -40,13 +219,350 @@ void ScriptDocs::Write(const char* filename, bool scripts)
 	}
 }
 
+void ScriptDocs::BuildIndex()
+{
+	Prepare();
+
+	m_symbols.clear();
+	m_symbolIndex.clear();
+
+	for (auto engine : m_engines)
+	{
+		// Object types, along with their methods and properties
+		int nTypes = engine->GetObjectTypeCount();
+		for (int i = 0; i < nTypes; i++)
+		{
+			asITypeInfo* type = engine->GetObjectTypeByIndex(i);
+			if (IsFiltered(type) || IsFoldedInstance(type))
+				continue;
+
+			std::string name = GetTemplateKey(type);
+			AddSymbol(name, SK_Type, engine, type, nullptr, -1);
+
+			int nMethods = type->GetMethodCount();
+			for (int j = 0; j < nMethods; j++)
+			{
+				asIScriptFunction* func = type->GetMethodByIndex(j);
+				if (func->GetObjectType() == type)
+					AddSymbol(name + "::" + func->GetName(), SK_Function, engine, type, func, -1);
+			}
+
+			int nProps = type->GetPropertyCount();
+			for (int j = 0; j < nProps; j++)
+			{
+				const char* propName;
+				type->GetProperty(j, &propName);
+				AddSymbol(name + "::" + propName, SK_Property, engine, type, nullptr, j);
+			}
+		}
+
+		// Enums, along with their values
+		int nEnums = engine->GetEnumCount();
+		for (int i = 0; i < nEnums; i++)
+		{
+			asITypeInfo* enumType = engine->GetEnumByIndex(i);
+			if (IsFiltered(enumType))
+				continue;
+
+			std::string name = GetTemplateKey(enumType);
+			AddSymbol(name, SK_Type, engine, enumType, nullptr, -1);
+
+			int nValues = enumType->GetEnumValueCount();
+			for (int j = 0; j < nValues; j++)
+				AddSymbol(name + "::" + enumType->GetEnumValueByIndex(j, nullptr), SK_EnumValue, engine, enumType, nullptr, j);
+		}
+
+		// Funcdefs
+		int nFuncDefs = engine->GetFuncdefCount();
+		for (int i = 0; i < nFuncDefs; i++)
+		{
+			asITypeInfo* funcdefType = engine->GetFuncdefByIndex(i);
+			if (!IsFiltered(funcdefType))
+				AddSymbol(GetTemplateKey(funcdefType), SK_Type, engine, funcdefType, nullptr, -1);
+		}
+
+		// Typedefs
+		int nTypeDefs = engine->GetTypedefCount();
+		for (int i = 0; i < nTypeDefs; i++)
+		{
+			asITypeInfo* typedefType = engine->GetTypedefByIndex(i);
+			if (!IsFiltered(typedefType))
+				AddSymbol(GetTemplateKey(typedefType), SK_Type, engine, typedefType, nullptr, -1);
+		}
+
+		// Global functions
+		int nGlobFuncs = engine->GetGlobalFunctionCount();
+		for (int i = 0; i < nGlobFuncs; i++)
+		{
+			asIScriptFunction* func = engine->GetGlobalFunctionByIndex(i);
+			if (IsFiltered(func))
+				continue;
+
+			const char* ns = func->GetNamespace();
+			std::string name = (ns != nullptr && ns[0] != '\0' ? std::string(ns) + "::" + func->GetName() : std::string(func->GetName()));
+			AddSymbol(name, SK_Function, engine, nullptr, func, -1);
+		}
+
+		// Global properties
+		int nGlobProps = engine->GetGlobalPropertyCount();
+		for (int i = 0; i < nGlobProps; i++)
+		{
+			const char* propName, *ns;
+			engine->GetGlobalPropertyByIndex(i, &propName, &ns);
+			if (IsFiltered(ns, propName, nullptr))
+				continue;
+
+			std::string name = (ns != nullptr && ns[0] != '\0' ? std::string(ns) + "::" + propName : std::string(propName));
+			AddSymbol(name, SK_GlobalProperty, engine, nullptr, nullptr, i);
+		}
+	}
+}
+
+bool ScriptDocs::Lookup(const char* name, char* buffer, size_t size)
+{
+	ScriptDocsSymbol* symbol = FindSymbol(name);
+	if (symbol == nullptr)
+		return false;
+
+	// Symbols are rendered the first time they're looked up, after that it's just a copy
+	if (!symbol->m_isRendered)
+		RenderSymbol(*symbol);
+
+	if (size > 0)
+	{
+		size_t length = std::min(symbol->m_rendered.size(), size - 1);
+		memcpy(buffer, symbol->m_rendered.c_str(), length);
+		buffer[length] = '\0';
+	}
+	return true;
+}
+
+void ScriptDocs::WriteUnusedReport(const char* filename)
+{
+	m_stream.open(filename, std::ofstream::out);
+	m_stream << "// Auto-generated unused bindings report" << std::endl;
+	m_stream << "// Global variable initializers can't be scanned, so bindings only used there are listed as unused" << std::endl << std::endl;
+
+	// Function and type IDs only mean something within their own engine, so each engine is checked on its own
+	for (size_t i = 0; i < m_engines.size(); i++)
+	{
+		if (IsMerging())
+			m_stream << "// Engine: " << m_engineNames[i] << std::endl;
+		WriteUnusedFor(m_engines[i]);
+	}
+	SetWriteEngine(m_engine);
+
+	m_stream.close();
+}
+
+void ScriptDocs::WriteUnusedFor(asIScriptEngine* engine)
+{
+	SetWriteEngine(engine);
+
+	m_usedFunctions.clear();
+	m_usedTemplateMethods.clear();
+	m_usedTemplateProperties.clear();
+	m_usedGlobals.clear();
+	m_usedProperties.clear();
+
+	// Gather the entry points of every loaded module
+	std::vector<asIScriptFunction*> scan;
+	int nModules = engine->GetModuleCount();
+	for (int i = 0; i < nModules; i++)
+	{
+		asIScriptModule* mod = engine->GetModuleByIndex(i);
+
+		int nFuncs = mod->GetFunctionCount();
+		for (int j = 0; j < nFuncs; j++)
+			scan.push_back(mod->GetFunctionByIndex(j));
+
+		int nTypes = mod->GetObjectTypeCount();
+		for (int j = 0; j < nTypes; j++)
+		{
+			asITypeInfo* type = mod->GetObjectTypeByIndex(j);
+
+			int nMethods = type->GetMethodCount();
+			for (int k = 0; k < nMethods; k++)
+				scan.push_back(type->GetMethodByIndex(k, false));
+
+			int nFactories = type->GetFactoryCount();
+			for (int k = 0; k < nFactories; k++)
+				scan.push_back(type->GetFactoryByIndex(k));
+
+			int nBehaviours = type->GetBehaviourCount();
+			for (int k = 0; k < nBehaviours; k++)
+			{
+				asEBehaviours beh;
+				scan.push_back(type->GetBehaviourByIndex(k, &beh));
+			}
+		}
+	}
+
+	// Walk the bytecode, following script calls so lambdas and other unlisted functions are covered too
+	int nScanned = 0;
+	std::unordered_set<int> scanned;
+	while (scan.size() > 0)
+	{
+		asIScriptFunction* func = scan.back();
+		scan.pop_back();
+
+		if (func == nullptr || !scanned.insert(func->GetId()).second)
+			continue;
+
+		ScanByteCode(func, scan);
+		nScanned++;
+	}
+
+	m_stream << "// Scanned " << nScanned << " script functions in " << nModules << " modules" << std::endl << std::endl;
+
+	// Global functions
+	m_stream << "// Global functions" << std::endl;
+	int nGlobFuncs = engine->GetGlobalFunctionCount();
+	for (int i = 0; i < nGlobFuncs; i++)
+	{
+		asIScriptFunction* func = engine->GetGlobalFunctionByIndex(i);
+		if (m_usedFunctions.find(func->GetId()) == m_usedFunctions.end())
+			m_stream << func->GetDeclaration(true, true, true) << std::endl;
+	}
+	m_stream << std::endl;
+
+	// Object methods and properties
+	m_stream << "// Methods and properties" << std::endl;
+	int nTypes = engine->GetObjectTypeCount();
+	for (int i = 0; i < nTypes; i++)
+	{
+		asITypeInfo* type = engine->GetObjectTypeByIndex(i);
+		bool isTemplate = (type->GetSubTypeCount() > 0);
+
+		int nMethods = type->GetMethodCount();
+		for (int j = 0; j < nMethods; j++)
+		{
+			asIScriptFunction* func = type->GetMethodByIndex(j);
+			if (func->GetObjectType() != type)
+				continue;
+
+			// Scripts call the methods of template instances, so match those by name instead of by ID
+			if (isTemplate && m_usedTemplateMethods.find(GetTemplateKey(type) + "::" + func->GetName()) != m_usedTemplateMethods.end())
+				continue;
+
+			if (m_usedFunctions.find(func->GetId()) == m_usedFunctions.end())
+				m_stream << func->GetDeclaration(true, true, true) << std::endl;
+		}
+
+		int nProps = type->GetPropertyCount();
+		for (int j = 0; j < nProps; j++)
+		{
+			const char* propName;
+			int propTypeID, propOffset;
+			type->GetProperty(j, &propName, &propTypeID, nullptr, nullptr, &propOffset);
+
+			// Same for properties, which are accessed by offset on the instance
+			if (isTemplate && m_usedTemplateProperties.find(GetTemplateKey(type) + "::" + std::to_string(propOffset)) != m_usedTemplateProperties.end())
+				continue;
+
+			unsigned long long key = ((unsigned long long)(unsigned int)type->GetTypeId() << 32) | (unsigned int)propOffset;
+			if (m_usedProperties.find(key) == m_usedProperties.end())
+				m_stream << GetTypeName(propTypeID) << " " << type->GetName() << "::" << propName << std::endl;
+		}
+	}
+	m_stream << std::endl;
+
+	// Global properties
+	m_stream << "// Global properties" << std::endl;
+	int nGlobProps = engine->GetGlobalPropertyCount();
+	for (int i = 0; i < nGlobProps; i++)
+	{
+		const char* propName, *ns;
+		int propTypeID;
+		bool isConst;
+		void* pointer;
+		engine->GetGlobalPropertyByIndex(i, &propName, &ns, &propTypeID, &isConst, nullptr, &pointer);
+
+		if (m_usedGlobals.find(pointer) != m_usedGlobals.end())
+			continue;
+
+		if (isConst)
+			m_stream << "const ";
+		m_stream << GetTypeName(propTypeID) << " ";
+		if (ns != nullptr && ns[0] != '\0')
+			m_stream << ns << "::";
+		m_stream << propName << std::endl;
+	}
+	m_stream << std::endl;
+}
+
+void ScriptDocs::WriteAudit(const char* filename)
+{
+	Prepare();
+
+	m_audit.clear();
+
+	for (auto engine : m_engines)
+	{
+		SetWriteEngine(engine);
+
+		// Object methods and operators
+		int nTypes = engine->GetObjectTypeCount();
+		for (int i = 0; i < nTypes; i++)
+		{
+			asITypeInfo* type = engine->GetObjectTypeByIndex(i);
+			if (IsFiltered(type) || IsFoldedInstance(type))
+				continue;
+
+			// Declarations shared between engines are only reported once
+			int nMethods = type->GetMethodCount();
+			for (int j = 0; j < nMethods; j++)
+			{
+				asIScriptFunction* func = type->GetMethodByIndex(j);
+				if (func->GetObjectType() == type && !IsWritten(GetFunctionKey(func)))
+					AuditFunction(func);
+			}
+
+			if (!IsWritten(GetTypeKey(type)))
+				AuditOperators(type);
+		}
+
+		// Global functions
+		int nGlobFuncs = engine->GetGlobalFunctionCount();
+		for (int i = 0; i < nGlobFuncs; i++)
+		{
+			asIScriptFunction* func = engine->GetGlobalFunctionByIndex(i);
+			if (!IsFiltered(func) && !IsWritten(GetFunctionKey(func)))
+				AuditFunction(func);
+		}
+	}
+	SetWriteEngine(m_engine);
+
+	// Most expensive first, keeping the registration order for equal costs
+	std::stable_sort(m_audit.begin(), m_audit.end(), [](const std::tuple<int, std::string, std::string> &a, const std::tuple<int, std::string, std::string> &b) {
+		return std::get<0>(a) > std::get<0>(b);
+	});
+
+	m_stream.open(filename, std::ofstream::out);
+	m_stream << "// Auto-generated binding performance audit" << std::endl;
+	m_stream << "// Sorted by estimated cost per call (roughly in bytes copied), highest first" << std::endl << std::endl;
+
+	for (auto &item : m_audit)
+	{
+		std::string cost = std::to_string(std::get<0>(item));
+		m_stream << std::string(cost.size() < 5 ? 5 - cost.size() : 0, ' ') << cost << "  " << std::get<1>(item) << std::endl;
+		m_stream << "       " << std::get<2>(item) << std::endl;
+	}
+
+	m_stream.close();
+}
+
 void ScriptDocs::WriteFor(asIScriptEngine* engine)
 {
+	SetWriteEngine(engine);
+
 	// For each object type
 	int nTypes = engine->GetObjectTypeCount();
 	for (int i = 0; i < nTypes; i++)
 	{
 		asITypeInfo* type = engine->GetObjectTypeByIndex(i);
+		if (IsFiltered(type))
+			continue;
 		WriteClass(type);
 	}
 
@@ -56,6 +572,8 @@ void ScriptDocs::WriteFor(asIScriptEngine* engine)
 	{
 		// Get info about the enum
 		asITypeInfo* enumType = engine->GetEnumByIndex(i);
+		if (IsFiltered(enumType))
+			continue;
 		WriteEnum(enumType);
 	}
 
@@ -65,11 +583,30 @@ void ScriptDocs::WriteFor(asIScriptEngine* engine)
 	{
 		// Get info about the funcdef
 		asITypeInfo* funcdefType = engine->GetFuncdefByIndex(i);
+		if (IsFiltered(funcdefType))
+			continue;
+
+		std::string key;
+		if (IsMerging() || IsTagging())
+			key = GetFuncdefKey(funcdefType);
+		if (IsMerging() && IsWritten(key))
+			continue;
 
 		// Write the funcdef
 		BeginNamespace(funcdefType->GetNamespace());
 		WriteHeader(funcdefType->GetUserData(AS_DOCS_USERDATA), false);
+		WriteAvailability(key);
+		WriteTagAnchor(key);
 		WriteFunction(funcdefType->GetFuncdefSignature(), true);
+
+		if (IsTagging())
+		{
+			const char* ns = funcdefType->GetNamespace();
+			void* userData = funcdefType->GetUserData(AS_DOCS_USERDATA);
+			asIScriptFunction* signature = funcdefType->GetFuncdefSignature();
+			AddTagGlobal(ns, userData, GetTagMember("typedef", GetReturnTypeName(signature) + "(*", funcdefType->GetName(),
+				GetTagScopeFile(ns, userData), key, ")(" + GetParamList(signature, MT_Normal, false) + ")"));
+		}
 	}
 
 	// For each typedef
@@ -78,6 +615,8 @@ void ScriptDocs::WriteFor(asIScriptEngine* engine)
 	{
 		// Get info about the typedef
 		asITypeInfo* typedefType = engine->GetTypedefByIndex(i);
+		if (IsFiltered(typedefType))
+			continue;
 		WriteTypedef(typedefType);
 	}
 
@@ -87,6 +626,8 @@ void ScriptDocs::WriteFor(asIScriptEngine* engine)
 	{
 		// Get info about the function
 		asIScriptFunction* func = engine->GetGlobalFunctionByIndex(i);
+		if (IsFiltered(func))
+			continue;
 		WriteGlobalFunction(func);
 	}
 
@@ -99,9 +640,18 @@ void ScriptDocs::WriteFor(asIScriptEngine* engine)
 		int propTypeID;
 		bool isConst;
 		engine->GetGlobalPropertyByIndex(i, &propName, &ns, &propTypeID, &isConst, nullptr, nullptr, nullptr);
+		if (IsFiltered(ns, propName, nullptr))
+			continue;
 		WriteGlobalVariable(propName, ns, propTypeID, isConst);
 	}
 
+	if (m_lastGroup != "")
+	{
+		m_indent--;
+		m_lastGroup = "";
+		m_stream << GetIndent() << "//! \\}" << std::endl << std::endl;
+	}
+
 	if (m_inNamespace != "")
 	{
 		m_indent--;
@@ -110,42 +660,475 @@ void ScriptDocs::WriteFor(asIScriptEngine* engine)
 	}
 }
 
-void ScriptDocs::WriteFor(asIScriptModule* mod)
+void ScriptDocs::Prepare()
 {
-	// For each object type
-	int nTypes = mod->GetObjectTypeCount();
-	for (int i = 0; i < nTypes; i++)
+	m_written.clear();
+	m_availability.clear();
+	m_typeVariants.clear();
+	m_templateTypes.clear();
+	m_templateInstances.clear();
+
+	// Find the template types so their instances can be folded into them
+	for (auto engine : m_engines)
+		GatherTemplates(engine);
+
+	// Find out which engines each declaration is available in
+	if (IsMerging())
 	{
-		asITypeInfo* type = mod->GetObjectTypeByIndex(i);
-		WriteClass(type);
+		for (size_t i = 0; i < m_engines.size(); i++)
+			GatherFor(m_engines[i], 1ULL << i);
 	}
+}
 
-	// For each enum
-	int nEnums = mod->GetEnumCount();
-	for (int i = 0; i < nEnums; i++)
+ScriptDocsSymbol* ScriptDocs::FindSymbol(const char* name)
+{
+	auto range = m_symbolIndex.equal_range(hashString(name));
+	for (auto it = range.first; it != range.second; it++)
 	{
-		// Get info about the enum
-		asITypeInfo* enumType = mod->GetEnumByIndex(i);
-		WriteEnum(enumType);
+		if (m_symbols[it->second].m_name == name)
+			return &m_symbols[it->second];
 	}
+	return nullptr;
+}
 
-	// For each typedef
-	int nTypeDefs = mod->GetTypedefCount();
-	for (int i = 0; i < nTypeDefs; i++)
+void ScriptDocs::AddSymbol(const std::string &name, SymbolKind kind, asIScriptEngine* engine, asITypeInfo* type, asIScriptFunction* func, int index)
+{
+	ScriptDocsSymbol* symbol = FindSymbol(name.c_str());
+	if (symbol == nullptr)
 	{
-		// Get info about the typedef
-		asITypeInfo* typedefType = mod->GetTypedefByIndex(i);
-		WriteTypedef(typedefType);
+		m_symbolIndex.emplace(hashString(name.c_str()), m_symbols.size());
+		m_symbols.emplace_back();
+
+		symbol = &m_symbols.back();
+		symbol->m_name = name;
+		symbol->m_kind = kind;
+		symbol->m_engine = engine;
+		symbol->m_type = type;
+		symbol->m_index = index;
 	}
+	else if (kind != SK_Function || symbol->m_kind != SK_Function)
+		return;
 
-	// For each global function
-	int nGlobFuncs = mod->GetFunctionCount();
-	for (int i = 0; i < nGlobFuncs; i++)
-	{
-		// Get info about the function
-		asIScriptFunction* func = mod->GetFunctionByIndex(i);
-		WriteGlobalFunction(func);
-	}
+	if (func == nullptr)
+		return;
+
+	// Overloads are collected in one symbol, but other engines may have registered the same one
+	if (IsMerging())
+	{
+		std::string key = GetFunctionKey(func);
+		for (auto overload : symbol->m_functions)
+		{
+			if (GetFunctionKey(overload) == key)
+				return;
+		}
+	}
+	symbol->m_functions.push_back(func);
+}
+
+void ScriptDocs::RenderSymbol(ScriptDocsSymbol &symbol)
+{
+	// Render through the usual writers, into a string instead of the file
+	std::stringbuf buffer;
+	std::streambuf* fileBuffer = static_cast<std::ostream&>(m_stream).rdbuf(&buffer);
+
+	m_indent = 0;
+	m_lastVis = MV_Public;
+	m_lastName = "";
+	m_lastGroup = "";
+	m_written.clear();
+	SetWriteEngine(symbol.m_engine);
+
+	// Pretend we're already in the symbol's namespace, since it's part of the name that was looked up
+	switch (symbol.m_kind)
+	{
+	case SK_Type:
+	{
+		asITypeInfo* type = symbol.m_type;
+		const char* ns = type->GetNamespace();
+		m_inNamespace = (ns == nullptr ? "" : ns);
+
+		asDWORD flags = type->GetFlags();
+		if (flags & asOBJ_ENUM)
+			WriteEnum(type);
+		else if (flags & asOBJ_TYPEDEF)
+			WriteTypedef(type);
+		else if (flags & asOBJ_FUNCDEF)
+		{
+			WriteHeader(type->GetUserData(AS_DOCS_USERDATA), false);
+			WriteAvailability(GetFuncdefKey(type));
+			WriteFunction(type->GetFuncdefSignature(), true);
+		}
+		else
+			WriteClass(type);
+		break;
+	}
+
+	case SK_Function:
+		for (auto func : symbol.m_functions)
+		{
+			SetWriteEngine(func->GetEngine());
+			const char* ns = func->GetNamespace();
+			m_inNamespace = (ns == nullptr ? "" : ns);
+			WriteFunctionHeader(func, func->GetObjectType() != nullptr);
+			WriteAvailability(GetFunctionKey(func));
+			WriteFunction(func);
+		}
+		break;
+
+	case SK_Property:
+	{
+		const char* propName;
+		int propTypeID;
+		bool propReference;
+		symbol.m_type->GetProperty(symbol.m_index, &propName, &propTypeID, nullptr, nullptr, nullptr, &propReference);
+
+		WriteAvailability(GetPropertyKey(symbol.m_type, symbol.m_index));
+		m_stream << GetIndent() << GetTypeName(propTypeID);
+		if (propReference)
+			m_stream << "&";
+		m_stream << " " << propName << ";" << std::endl;
+		break;
+	}
+
+	case SK_GlobalProperty:
+	{
+		const char* propName, *ns;
+		int propTypeID;
+		bool isConst;
+		symbol.m_engine->GetGlobalPropertyByIndex(symbol.m_index, &propName, &ns, &propTypeID, &isConst);
+
+		m_inNamespace = (ns == nullptr ? "" : ns);
+		WriteGlobalVariable(propName, ns, propTypeID, isConst);
+		break;
+	}
+
+	case SK_EnumValue:
+	{
+		int value;
+		const char* valueName = symbol.m_type->GetEnumValueByIndex(symbol.m_index, &value);
+
+		WriteAvailability(GetEnumValueKey(symbol.m_type, symbol.m_index));
+		m_stream << GetIndent() << valueName << " = " << value << "," << std::endl;
+		break;
+	}
+	}
+
+	if (m_lastGroup != "")
+	{
+		m_indent--;
+		m_lastGroup = "";
+		m_stream << GetIndent() << "//! \\}" << std::endl;
+	}
+	m_inNamespace = "";
+
+	static_cast<std::ostream&>(m_stream).rdbuf(fileBuffer);
+	SetWriteEngine(m_engine);
+
+	symbol.m_rendered = buffer.str();
+	symbol.m_isRendered = true;
+}
+
+void ScriptDocs::GatherFor(asIScriptEngine* engine, unsigned long long mask)
+{
+	SetWriteEngine(engine);
+
+	// For each object type and enum, along with their members
+	int nTypes = engine->GetObjectTypeCount();
+	int nEnums = engine->GetEnumCount();
+	for (int i = 0; i < nTypes + nEnums; i++)
+	{
+		asITypeInfo* type = (i < nTypes ? engine->GetObjectTypeByIndex(i) : engine->GetEnumByIndex(i - nTypes));
+		if (IsFiltered(type) || IsFoldedInstance(type))
+			continue;
+
+		std::string key = GetTypeKey(type);
+		m_availability[key] |= mask;
+		m_typeVariants[key].push_back(type);
+
+		int nProps = type->GetPropertyCount();
+		for (int j = 0; j < nProps; j++)
+			m_availability[GetPropertyKey(type, j)] |= mask;
+
+		int nMethods = type->GetMethodCount();
+		for (int j = 0; j < nMethods; j++)
+		{
+			asIScriptFunction* func = type->GetMethodByIndex(j);
+			if (func->GetObjectType() == type)
+				m_availability[GetFunctionKey(func)] |= mask;
+		}
+
+		int nValues = type->GetEnumValueCount();
+		for (int j = 0; j < nValues; j++)
+			m_availability[GetEnumValueKey(type, j)] |= mask;
+	}
+
+	// For each funcdef
+	int nFuncDefs = engine->GetFuncdefCount();
+	for (int i = 0; i < nFuncDefs; i++)
+	{
+		asITypeInfo* funcdefType = engine->GetFuncdefByIndex(i);
+		if (!IsFiltered(funcdefType))
+			m_availability[GetFuncdefKey(funcdefType)] |= mask;
+	}
+
+	// For each typedef
+	int nTypeDefs = engine->GetTypedefCount();
+	for (int i = 0; i < nTypeDefs; i++)
+	{
+		asITypeInfo* typedefType = engine->GetTypedefByIndex(i);
+		if (!IsFiltered(typedefType))
+			m_availability[GetTypeKey(typedefType)] |= mask;
+	}
+
+	// For each global function
+	int nGlobFuncs = engine->GetGlobalFunctionCount();
+	for (int i = 0; i < nGlobFuncs; i++)
+	{
+		asIScriptFunction* func = engine->GetGlobalFunctionByIndex(i);
+		if (!IsFiltered(func))
+			m_availability[GetFunctionKey(func)] |= mask;
+	}
+
+	// For each global property
+	int nGlobProps = engine->GetGlobalPropertyCount();
+	for (int i = 0; i < nGlobProps; i++)
+	{
+		const char* propName, *ns;
+		int propTypeID;
+		bool isConst;
+		engine->GetGlobalPropertyByIndex(i, &propName, &ns, &propTypeID, &isConst, nullptr, nullptr, nullptr);
+		if (!IsFiltered(ns, propName, nullptr))
+			m_availability[GetGlobalVariableKey(propName, ns, propTypeID, isConst)] |= mask;
+	}
+}
+
+void ScriptDocs::GatherTemplates(asIScriptEngine* engine)
+{
+	int nTypes = engine->GetObjectTypeCount();
+	for (int i = 0; i < nTypes; i++)
+	{
+		asITypeInfo* type = engine->GetObjectTypeByIndex(i);
+		if (type->GetSubTypeCount() == 0 || IsFiltered(type))
+			continue;
+
+		std::string key = GetTemplateKey(type);
+		if (!IsTemplateInstance(type))
+		{
+			m_templateTypes.emplace(key, type);
+			continue;
+		}
+
+		std::string decl = engine->GetTypeDeclaration(type->GetTypeId(), true);
+		std::vector<std::string> &instances = m_templateInstances[key];
+		if (std::find(instances.begin(), instances.end(), decl) == instances.end())
+			instances.push_back(decl);
+	}
+}
+
+void ScriptDocs::SetWriteEngine(asIScriptEngine* engine)
+{
+	// Type IDs are only meaningful to the engine they came from
+	m_writeEngine = engine;
+	m_stringType = engine->GetTypeInfoByDecl("string");
+}
+
+bool ScriptDocs::IsFiltered(asITypeInfo* type)
+{
+	return IsFiltered(type->GetNamespace(), type->GetName(), type->GetUserData(AS_DOCS_USERDATA));
+}
+
+bool ScriptDocs::IsFiltered(asIScriptFunction* func)
+{
+	return IsFiltered(func->GetNamespace(), func->GetName(), func->GetUserData(AS_DOCS_USERDATA));
+}
+
+bool ScriptDocs::IsFiltered(const char* ns, const char* name, void* userData)
+{
+	if (ns == nullptr)
+		ns = "";
+
+	// Namespaces match themselves and everything nested inside them
+	auto matchNamespace = [ns](const std::string &filter) {
+		size_t len = filter.size();
+		return strncmp(ns, filter.c_str(), len) == 0 && (ns[len] == '\0' || (ns[len] == ':' && ns[len + 1] == ':'));
+	};
+	if (m_includeNamespaces.size() > 0 && std::none_of(m_includeNamespaces.begin(), m_includeNamespaces.end(), matchNamespace))
+		return true;
+	if (std::any_of(m_excludeNamespaces.begin(), m_excludeNamespaces.end(), matchNamespace))
+		return true;
+
+	ScriptDocsMetadata* meta = (ScriptDocsMetadata*)userData;
+	if (m_includeGroups.size() > 0 || m_excludeGroups.size() > 0)
+	{
+		static const std::string noGroup;
+		const std::string &group = (meta != nullptr ? meta->m_group : noGroup);
+		if (m_includeGroups.size() > 0 && std::find(m_includeGroups.begin(), m_includeGroups.end(), group) == m_includeGroups.end())
+			return true;
+		if (std::find(m_excludeGroups.begin(), m_excludeGroups.end(), group) != m_excludeGroups.end())
+			return true;
+	}
+
+	if (m_includeNames.size() > 0 || m_excludeNames.size() > 0)
+	{
+		std::string fullName = (ns[0] != '\0' ? std::string(ns) + "::" + name : std::string(name));
+		auto matchName = [&fullName](const std::string &pattern) { return wildcardMatch(pattern.c_str(), fullName.c_str()); };
+		if (m_includeNames.size() > 0 && std::none_of(m_includeNames.begin(), m_includeNames.end(), matchName))
+			return true;
+		if (std::any_of(m_excludeNames.begin(), m_excludeNames.end(), matchName))
+			return true;
+	}
+
+	if (m_filter && !m_filter(ns, name, meta))
+		return true;
+
+	return false;
+}
+
+bool ScriptDocs::IsMerging()
+{
+	return m_engines.size() > 1;
+}
+
+bool ScriptDocs::IsWritten(const std::string &key)
+{
+	return !m_written.insert(key).second;
+}
+
+std::string ScriptDocs::GetTypeKey(asITypeInfo* type)
+{
+	asDWORD flags = type->GetFlags();
+	std::string ret;
+	if (flags & asOBJ_ENUM) ret = "enum ";
+	else if (flags & asOBJ_TYPEDEF) ret = "typedef ";
+	else ret = "class ";
+
+	ret += type->GetEngine()->GetTypeDeclaration(type->GetTypeId(), true);
+
+	if (flags & asOBJ_TYPEDEF)
+		ret += std::string(" = ") + type->GetEngine()->GetTypeDeclaration(type->GetTypedefTypeId(), true);
+
+	return ret;
+}
+
+std::string ScriptDocs::GetFuncdefKey(asITypeInfo* funcdefType)
+{
+	return std::string("funcdef ") + funcdefType->GetFuncdefSignature()->GetDeclaration(true, true, false);
+}
+
+std::string ScriptDocs::GetFunctionKey(asIScriptFunction* func)
+{
+	return std::string("function ") + func->GetDeclaration(true, true, false);
+}
+
+std::string ScriptDocs::GetPropertyKey(asITypeInfo* type, int index)
+{
+	return std::string("property ") + type->GetEngine()->GetTypeDeclaration(type->GetTypeId(), true) + "::" + type->GetPropertyDeclaration(index, true);
+}
+
+std::string ScriptDocs::GetEnumValueKey(asITypeInfo* enumType, int index)
+{
+	int value;
+	const char* valueName = enumType->GetEnumValueByIndex(index, &value);
+	return std::string("value ") + enumType->GetEngine()->GetTypeDeclaration(enumType->GetTypeId(), true) + "::" + valueName + " = " + std::to_string(value);
+}
+
+std::string ScriptDocs::GetGlobalVariableKey(const char* propName, const char* ns, int propTypeID, bool isConst)
+{
+	std::string ret = "global ";
+	if (isConst)
+		ret += "const ";
+	ret += GetTypeName(propTypeID) + " ";
+	if (ns != nullptr && ns[0] != '\0')
+		ret += std::string(ns) + "::";
+	return ret + propName;
+}
+
+std::vector<asITypeInfo*> ScriptDocs::GetTypeVariants(asITypeInfo* type, const std::string &key)
+{
+	auto it = m_typeVariants.find(key);
+	if (it == m_typeVariants.end())
+		return std::vector<asITypeInfo*>(1, type);
+	return it->second;
+}
+
+std::string ScriptDocs::GetTemplateKey(asITypeInfo* type)
+{
+	const char* ns = type->GetNamespace();
+	if (ns == nullptr || ns[0] == '\0')
+		return type->GetName();
+	return std::string(ns) + "::" + type->GetName();
+}
+
+bool ScriptDocs::IsTemplateInstance(asITypeInfo* type)
+{
+	if (type->GetSubTypeCount() == 0)
+		return false;
+
+	// The template itself has placeholder subtypes, instances have actual types (which are null for primitives)
+	asITypeInfo* subType = type->GetSubType(0);
+	return subType == nullptr || !(subType->GetFlags() & asOBJ_TEMPLATE_SUBTYPE);
+}
+
+bool ScriptDocs::IsFoldedInstance(asITypeInfo* type)
+{
+	if (!IsTemplateInstance(type))
+		return false;
+
+	std::string key = GetTemplateKey(type);
+	if (m_templateTypes.find(key) != m_templateTypes.end())
+		return true;
+
+	// Without the template itself, the first instance we found stands in for it
+	auto it = m_templateInstances.find(key);
+	if (it == m_templateInstances.end())
+		return false;
+	return it->second[0] != type->GetEngine()->GetTypeDeclaration(type->GetTypeId(), true);
+}
+
+void ScriptDocs::WriteFor(asIScriptModule* mod)
+{
+	// For each object type
+	int nTypes = mod->GetObjectTypeCount();
+	for (int i = 0; i < nTypes; i++)
+	{
+		asITypeInfo* type = mod->GetObjectTypeByIndex(i);
+		if (IsFiltered(type))
+			continue;
+		WriteClass(type);
+	}
+
+	// For each enum
+	int nEnums = mod->GetEnumCount();
+	for (int i = 0; i < nEnums; i++)
+	{
+		// Get info about the enum
+		asITypeInfo* enumType = mod->GetEnumByIndex(i);
+		if (IsFiltered(enumType))
+			continue;
+		WriteEnum(enumType);
+	}
+
+	// For each typedef
+	int nTypeDefs = mod->GetTypedefCount();
+	for (int i = 0; i < nTypeDefs; i++)
+	{
+		// Get info about the typedef
+		asITypeInfo* typedefType = mod->GetTypedefByIndex(i);
+		if (IsFiltered(typedefType))
+			continue;
+		WriteTypedef(typedefType);
+	}
+
+	// For each global function
+	int nGlobFuncs = mod->GetFunctionCount();
+	for (int i = 0; i < nGlobFuncs; i++)
+	{
+		// Get info about the function
+		asIScriptFunction* func = mod->GetFunctionByIndex(i);
+		if (IsFiltered(func))
+			continue;
+		WriteGlobalFunction(func);
+	}
 
 	// For each global property
 	int nGlobProps = mod->GetGlobalVarCount();
@@ -156,9 +1139,18 @@ void ScriptDocs::WriteFor(asIScriptModule* mod)
 		int propTypeID;
 		bool isConst;
 		mod->GetGlobalVar(i, &propName, &ns, &propTypeID, &isConst);
+		if (IsFiltered(ns, propName, nullptr))
+			continue;
 		WriteGlobalVariable(propName, ns, propTypeID, isConst);
 	}
 
+	if (m_lastGroup != "")
+	{
+		m_indent--;
+		m_lastGroup = "";
+		m_stream << GetIndent() << "//! \\}" << std::endl << std::endl;
+	}
+
 	if (m_inNamespace != "")
 	{
 		m_indent--;
@@ -223,7 +1215,7 @@ std::string ScriptDocs::GetTypeName(int typeID)
 	case asTYPEID_DOUBLE: return "double";
 	}
 
-	asITypeInfo* type = m_engine->GetTypeInfoById(typeID);
+	asITypeInfo* type = m_writeEngine->GetTypeInfoById(typeID);
 	std::string ret = type->GetName();
 
 	int nSubTypes = type->GetSubTypeCount();
@@ -245,36 +1237,122 @@ std::string ScriptDocs::GetTypeName(int typeID)
 	return ret;
 }
 
-std::tuple<const char*, MethodTrait> ScriptDocs::GetFunctionName(const std::string &name)
+std::string ScriptDocs::GetReturnTypeName(asIScriptFunction* func)
 {
-	//TODO: Some of these could be made better (eg. opCmp covers 4 operators, but we only show operator<, no distinction between opPreInc and opPostInc, etc)
-	if (name == "opNeg") return std::make_tuple("operator-", MT_Normal);
-	if (name == "opCom") return std::make_tuple("operator~", MT_Normal);
-	if (name == "opPreInc" || name == "opPostInc") return std::make_tuple("operator++", MT_Normal);
-	if (name == "opPreDec" || name == "opPostDec") return std::make_tuple("operator--", MT_Normal);
-	if (name == "opEquals") return std::make_tuple("operator==", MT_Normal);
-	if (name == "opCmp") return std::make_tuple("operator<", MT_Normal);
+	asDWORD dwReturnTypeFlags;
+	int funcReturnTypeID = func->GetReturnTypeId(&dwReturnTypeFlags);
 
-	if (name == "opAssign") return std::make_tuple("operator=", MT_Normal);
-	if (name == "opAddAssign") return std::make_tuple("operator+=", MT_Normal);
-	if (name == "opSubAssign") return std::make_tuple("operator-=", MT_Normal);
-	if (name == "opMulAssign") return std::make_tuple("operator*=", MT_Normal);
-	if (name == "opDivAssign") return std::make_tuple("operator/=", MT_Normal);
-	if (name == "opModAssign") return std::make_tuple("operator%=", MT_Normal);
-	if (name == "opPowAssign") return std::make_tuple("operator**=", MT_Normal);
-	if (name == "opAndAssign") return std::make_tuple("operator&=", MT_Normal);
-	if (name == "opOrAssign") return std::make_tuple("operator|=", MT_Normal);
-	if (name == "opXorAssign") return std::make_tuple("operator^=", MT_Normal);
-	if (name == "opShlAssign") return std::make_tuple("operator<<=", MT_Normal);
-	if (name == "opShrAssign") return std::make_tuple("operator>>=", MT_Normal);
-	if (name == "opUShrAssign") return std::make_tuple("operator>>>=", MT_Normal);
+	if (dwReturnTypeFlags & asTYPEID_OBJHANDLE)
+		return GetTypeName(funcReturnTypeID) + "*";
+	else if (dwReturnTypeFlags & asTYPEID_HANDLETOCONST)
+		return "const " + GetTypeName(funcReturnTypeID) + "*";
+	return GetTypeName(funcReturnTypeID);
+}
 
-#define BOTH_OPS(str, op) \
-if (name == str) return std::make_tuple("operator" op, MT_Arithmetic); \
-if (name == str "_r") return std::make_tuple("operator" op, MT_Arithmetic_r);
-	BOTH_OPS("opAdd", "+");
-	BOTH_OPS("opSub", "-");
-	BOTH_OPS("opMul", "*");
+std::string ScriptDocs::GetParamList(asIScriptFunction* func, MethodTrait trait, bool defaults)
+{
+	std::string ret;
+
+	// Get parameter count
+	int nParams = func->GetParamCount();
+
+	// Special case: For methods marked with arithmatic trait, we need to add the "this" parameter.
+	// string operator+(string, float); // MT_Arithmatic
+	// string operator+(float, string); // MT_Arithmatic_r
+	if (trait == MT_Arithmetic)
+	{
+		auto typeObject = func->GetObjectType();
+		if (typeObject != nullptr)
+		{
+			ret += GetTypeName(typeObject->GetTypeId());
+			if (nParams > 0)
+				ret += ", ";
+		}
+	}
+
+	// For each function parameter
+	for (int i = 0; i < nParams; i++)
+	{
+		// Get info about the parameter
+		const char* paramName;
+		const char* paramDefault;
+		int paramTypeID;
+		asDWORD paramFlags;
+		func->GetParam(i, &paramTypeID, &paramFlags, &paramName, &paramDefault);
+
+		// Write the parameter
+		if (paramFlags & asTM_CONST)
+			ret += "const ";
+		ret += GetTypeName(paramTypeID);
+		if (paramFlags & asTM_INOUTREF)
+			ret += "&";
+
+		if (paramName != nullptr && strlen(paramName) > 0)
+			ret += std::string(" ") + paramName;
+
+		if (defaults && paramDefault != nullptr)
+		{
+			// Angelscript returns this to us in space-delimited keywords, eg: "- 1", "vec2 ( 0 , 0 )", "Foo :: Bar"
+			if (m_stringType != nullptr && paramTypeID == m_stringType->GetTypeId())
+				ret += std::string(" = ") + paramDefault;
+			else
+			{
+				// Remove spaces
+				std::string strParamDefault(paramDefault);
+				strParamDefault.erase(std::remove_if(strParamDefault.begin(), strParamDefault.end(), ::isspace), strParamDefault.end());
+				ret += " = " + strParamDefault;
+			}
+		}
+
+		// Maybe another parameter
+		if (i + 1 < nParams)
+			ret += ", ";
+	}
+
+	if (trait == MT_Arithmetic_r)
+	{
+		auto typeObject = func->GetObjectType();
+		if (typeObject != nullptr)
+		{
+			if (nParams > 0)
+				ret += ", ";
+			ret += GetTypeName(typeObject->GetTypeId());
+		}
+	}
+
+	return ret;
+}
+
+std::tuple<const char*, MethodTrait> ScriptDocs::GetFunctionName(const std::string &name)
+{
+	//TODO: Some of these could be made better (eg. opCmp covers 4 operators, but we only show operator<, no distinction between opPreInc and opPostInc, etc)
+	if (name == "opNeg") return std::make_tuple("operator-", MT_Normal);
+	if (name == "opCom") return std::make_tuple("operator~", MT_Normal);
+	if (name == "opPreInc" || name == "opPostInc") return std::make_tuple("operator++", MT_Normal);
+	if (name == "opPreDec" || name == "opPostDec") return std::make_tuple("operator--", MT_Normal);
+	if (name == "opEquals") return std::make_tuple("operator==", MT_Normal);
+	if (name == "opCmp") return std::make_tuple("operator<", MT_Normal);
+
+	if (name == "opAssign") return std::make_tuple("operator=", MT_Normal);
+	if (name == "opAddAssign") return std::make_tuple("operator+=", MT_Normal);
+	if (name == "opSubAssign") return std::make_tuple("operator-=", MT_Normal);
+	if (name == "opMulAssign") return std::make_tuple("operator*=", MT_Normal);
+	if (name == "opDivAssign") return std::make_tuple("operator/=", MT_Normal);
+	if (name == "opModAssign") return std::make_tuple("operator%=", MT_Normal);
+	if (name == "opPowAssign") return std::make_tuple("operator**=", MT_Normal);
+	if (name == "opAndAssign") return std::make_tuple("operator&=", MT_Normal);
+	if (name == "opOrAssign") return std::make_tuple("operator|=", MT_Normal);
+	if (name == "opXorAssign") return std::make_tuple("operator^=", MT_Normal);
+	if (name == "opShlAssign") return std::make_tuple("operator<<=", MT_Normal);
+	if (name == "opShrAssign") return std::make_tuple("operator>>=", MT_Normal);
+	if (name == "opUShrAssign") return std::make_tuple("operator>>>=", MT_Normal);
+
+#define BOTH_OPS(str, op) \
+if (name == str) return std::make_tuple("operator" op, MT_Arithmetic); \
+if (name == str "_r") return std::make_tuple("operator" op, MT_Arithmetic_r);
+	BOTH_OPS("opAdd", "+");
+	BOTH_OPS("opSub", "-");
+	BOTH_OPS("opMul", "*");
 	BOTH_OPS("opDiv", "/");
 	BOTH_OPS("opMod", "%");
 	BOTH_OPS("opPow", "**");
@@ -293,13 +1371,28 @@ if (name == str "_r") return std::make_tuple("operator" op, MT_Arithmetic_r);
 
 void ScriptDocs::WriteClass(asITypeInfo* type)
 {
+	// Template instances are listed with their template instead
+	if (IsFoldedInstance(type))
+		return;
+
+	std::string key;
+	if (IsMerging() || IsTagging())
+		key = GetTypeKey(type);
+	if (IsMerging() && IsWritten(key))
+		return;
+
 	// Write the class
 	BeginNamespace(type->GetNamespace());
 
 	WriteHeader(type->GetUserData(AS_DOCS_USERDATA), false);
+	WriteAvailability(key);
+	WriteInstantiations(type);
 
+	bool isInstance = IsTemplateInstance(type);
 	int nSubTypes = type->GetSubTypeCount();
-	if (nSubTypes > 0)
+	if (isInstance)
+		m_stream << GetIndent() << "template<>" << std::endl;
+	else if (nSubTypes > 0)
 	{
 		m_stream << GetIndent() << "template<";
 		for (int j = 0; j < nSubTypes; j++)
@@ -331,104 +1424,187 @@ void ScriptDocs::WriteClass(asITypeInfo* type)
 			inheritance += ", ";
 	}
 
-	m_stream << GetIndent() << "class " << type->GetName() << inheritance << std::endl;
+	m_stream << GetIndent() << "class " << (isInstance ? GetTypeName(type->GetTypeId()) : type->GetName()) << inheritance << std::endl;
 	m_stream << GetIndent() << "{" << std::endl;
 	m_indent++;
 
+	// The class might be registered in multiple engines, so we write the union of their members
+	std::vector<asITypeInfo*> variants = GetTypeVariants(type, key);
+
+	std::string tagFile, tagMembers;
+	if (IsTagging())
+		tagFile = AddTagClass(type);
+
 	m_lastVis = MV_None;
 
 	// For each property
-	int nProps = type->GetPropertyCount();
-	for (int i = 0; i < nProps; i++)
+	for (auto variant : variants)
 	{
-		// Get info about the property
-		const char* propName;
-		int propTypeID, propOffset;
-		bool propPrivate, propProtected, propReference;
-
-		type->GetProperty(i, &propName, &propTypeID, &propPrivate, &propProtected, &propOffset, &propReference);
+		SetWriteEngine(variant->GetEngine());
+		baseType = variant->GetBaseType();
 
-		// Kind of a hack: Exclude if this property is inherited from one of its base classes
-		bool isInherited = false;
-		while (baseType != nullptr)
+		int nProps = variant->GetPropertyCount();
+		for (int i = 0; i < nProps; i++)
 		{
-			int nBaseProps = baseType->GetPropertyCount();
-			for (int j = 0; j < nBaseProps; j++)
+			// Get info about the property
+			const char* propName;
+			int propTypeID, propOffset;
+			bool propPrivate, propProtected, propReference;
+
+			variant->GetProperty(i, &propName, &propTypeID, &propPrivate, &propProtected, &propOffset, &propReference);
+
+			// Kind of a hack: Exclude if this property is inherited from one of its base classes
+			bool isInherited = false;
+			while (baseType != nullptr)
 			{
-				int basePropOffset;
-				baseType->GetProperty(j, nullptr, nullptr, nullptr, nullptr, &basePropOffset);
-				if (basePropOffset == propOffset)
+				int nBaseProps = baseType->GetPropertyCount();
+				for (int j = 0; j < nBaseProps; j++)
 				{
-					isInherited = true;
-					break;
+					int basePropOffset;
+					baseType->GetProperty(j, nullptr, nullptr, nullptr, nullptr, &basePropOffset);
+					if (basePropOffset == propOffset)
+					{
+						isInherited = true;
+						break;
+					}
 				}
+				if (isInherited)
+					break;
+				baseType = baseType->GetBaseType();
 			}
 			if (isInherited)
-				break;
-			baseType = baseType->GetBaseType();
+				continue;
+
+			std::string propKey;
+			if (IsMerging() || IsTagging())
+				propKey = GetPropertyKey(variant, i);
+			if (IsMerging() && IsWritten(propKey))
+				continue;
+
+			// Get the visibility
+			MemberVisibility vis = MV_Public;
+			if (propPrivate) vis = MV_Private;
+			else if (propProtected) vis = MV_Protected;
+
+			WriteVisibility(vis);
+
+			//TODO: Set description for properties (they don't have an asITypeInfo object)
+			//WriteHeader(type->GetUserData(AS_DOCS_USERDATA_DESC));
+			WriteAvailability(propKey, key);
+			WriteTagAnchor(propKey);
+
+			// Write the property
+			m_stream << GetIndent() << GetTypeName(propTypeID);
+			if (propReference)
+				m_stream << "&";
+			m_stream << " " << propName << ";" << std::endl;
+
+			if (IsTagging())
+				tagMembers += GetTagMember("variable", GetTypeName(propTypeID), propName, tagFile, propKey, "");
 		}
-		if (isInherited)
-			continue;
-
-		// Get the visibility
-		MemberVisibility vis = MV_Public;
-		if (propPrivate) vis = MV_Private;
-		else if (propProtected) vis = MV_Protected;
-
-		WriteVisibility(vis);
-
-		//TODO: Set description for properties (they don't have an asITypeInfo object)
-		//WriteHeader(type->GetUserData(AS_DOCS_USERDATA_DESC));
-
-		// Write the property
-		m_stream << GetIndent() << GetTypeName(propTypeID);
-		if (propReference)
-			m_stream << "&";
-		m_stream << " " << propName << ";" << std::endl;
 	}
 
 	m_lastVis = MV_None;
 
 	// For each method
-	int nMethods = type->GetMethodCount();
-	for (int j = 0; j < nMethods; j++)
+	for (auto variant : variants)
 	{
-		// Write the function
-		asIScriptFunction* func = type->GetMethodByIndex(j);
-
-		// Filter inherited methods
-		if (func->GetObjectType() != type)
-			continue;
+		SetWriteEngine(variant->GetEngine());
 
-		WriteHeader(func->GetUserData(AS_DOCS_USERDATA), true);
-		WriteFunction(func);
+		int nMethods = variant->GetMethodCount();
+		for (int j = 0; j < nMethods; j++)
+		{
+			// Write the function
+			asIScriptFunction* func = variant->GetMethodByIndex(j);
+
+			// Filter inherited methods
+			if (func->GetObjectType() != variant)
+				continue;
+
+			std::string funcKey;
+			if (IsMerging() || IsTagging())
+				funcKey = GetFunctionKey(func);
+			if (IsMerging() && IsWritten(funcKey))
+				continue;
+
+			// Switch visibility before the docs, so they stay attached to the method
+			WriteVisibility(GetVisibility(func));
+			WriteFunctionHeader(variant->GetMethodByIndex(j, false), true);
+			WriteAvailability(funcKey, key);
+			WriteTagAnchor(funcKey);
+			WriteFunction(func);
+
+			if (IsTagging())
+				tagMembers += GetTagFunction(func, tagFile, funcKey);
+		}
 	}
 
+	SetWriteEngine(type->GetEngine());
+
+	if (IsTagging())
+		WriteTagClass(type, tagFile, tagMembers);
+
 	m_indent--;
 	m_stream << GetIndent() << "};" << std::endl;
 }
 
 void ScriptDocs::WriteEnum(asITypeInfo* enumType)
 {
+	std::string key;
+	if (IsMerging() || IsTagging())
+		key = GetTypeKey(enumType);
+	if (IsMerging() && IsWritten(key))
+		return;
+
 	// Write the enum
 	BeginNamespace(enumType->GetNamespace());
 	WriteHeader(enumType->GetUserData(AS_DOCS_USERDATA), false);
+	WriteAvailability(key);
+	WriteTagAnchor(key);
 	m_stream << GetIndent() << "enum " << enumType->GetName() << std::endl;
 	m_stream << GetIndent() << "{" << std::endl;
 	m_indent++;
 
-	// For each enum value
-	int nValues = enumType->GetEnumValueCount();
-	for (int j = 0; j < nValues; j++)
+	std::string tagFile, tagValues, tagMembers;
+	if (IsTagging())
+		tagFile = GetTagScopeFile(enumType->GetNamespace(), enumType->GetUserData(AS_DOCS_USERDATA));
+
+	// For each enum value, in every engine that has this enum
+	for (auto variant : GetTypeVariants(enumType, key))
 	{
-		int value;
-		const char* valueName = enumType->GetEnumValueByIndex(j, &value);
+		int nValues = variant->GetEnumValueCount();
+		for (int j = 0; j < nValues; j++)
+		{
+			int value;
+			const char* valueName = variant->GetEnumValueByIndex(j, &value);
 
-		//TODO: Set description for enum values (they don't have an asITypeInfo object)
-		//WriteHeader(enumType->GetUserData(AS_DOCS_USERDATA_DESC));
+			std::string valueKey;
+			if (IsMerging() || IsTagging())
+				valueKey = GetEnumValueKey(variant, j);
+			if (IsMerging() && IsWritten(valueKey))
+				continue;
 
-		// Write the value
-		m_stream << GetIndent() << valueName << " = " << value << "," << std::endl;
+			//TODO: Set description for enum values (they don't have an asITypeInfo object)
+			//WriteHeader(enumType->GetUserData(AS_DOCS_USERDATA_DESC));
+			WriteAvailability(valueKey, key);
+			WriteTagAnchor(valueKey);
+
+			// Write the value
+			m_stream << GetIndent() << valueName << " = " << value << "," << std::endl;
+
+			if (IsTagging())
+			{
+				tagValues += "      <enumvalue file=\"" + tagFile + "\" anchor=\"" + GetTagAnchor(valueKey) + "\">" + xmlEscape(valueName) + "</enumvalue>\n";
+				tagMembers += GetTagMember("enumvalue", "", valueName, tagFile, valueKey, "");
+			}
+		}
+	}
+
+	if (IsTagging())
+	{
+		const char* ns = enumType->GetNamespace();
+		void* userData = enumType->GetUserData(AS_DOCS_USERDATA);
+		AddTagGlobal(ns, userData, GetTagMember("enumeration", "", enumType->GetName(), tagFile, key, "", tagValues) + tagMembers);
 	}
 
 	m_indent--;
@@ -437,34 +1613,75 @@ void ScriptDocs::WriteEnum(asITypeInfo* enumType)
 
 void ScriptDocs::WriteTypedef(asITypeInfo* typedefType)
 {
+	std::string key;
+	if (IsMerging() || IsTagging())
+		key = GetTypeKey(typedefType);
+	if (IsMerging() && IsWritten(key))
+		return;
+
 	// Write the typedef
 	BeginNamespace(typedefType->GetNamespace());
 	WriteHeader(typedefType->GetUserData(AS_DOCS_USERDATA), false);
+	WriteAvailability(key);
+	WriteTagAnchor(key);
 	m_stream << GetIndent() << "typedef " << GetTypeName(typedefType->GetTypedefTypeId());
 	m_stream << " " << typedefType->GetName() << ";" << std::endl;
+
+	if (IsTagging())
+	{
+		const char* ns = typedefType->GetNamespace();
+		void* userData = typedefType->GetUserData(AS_DOCS_USERDATA);
+		AddTagGlobal(ns, userData, GetTagMember("typedef", GetTypeName(typedefType->GetTypedefTypeId()), typedefType->GetName(), GetTagScopeFile(ns, userData), key, ""));
+	}
 }
 
 void ScriptDocs::WriteGlobalFunction(asIScriptFunction* func)
 {
+	std::string key;
+	if (IsMerging() || IsTagging())
+		key = GetFunctionKey(func);
+	if (IsMerging() && IsWritten(key))
+		return;
+
 	// Write the function
 	BeginNamespace(func->GetNamespace());
-	WriteHeader(func->GetUserData(AS_DOCS_USERDATA), false);
+	WriteFunctionHeader(func, false);
+	WriteAvailability(key);
+	WriteTagAnchor(key);
 	WriteFunction(func);
+
+	if (IsTagging())
+	{
+		const char* ns = func->GetNamespace();
+		void* userData = func->GetUserData(AS_DOCS_USERDATA);
+		AddTagGlobal(ns, userData, GetTagFunction(func, GetTagScopeFile(ns, userData), key));
+	}
 }
 
 void ScriptDocs::WriteGlobalVariable(const char* propName, const char* ns, int propTypeID, bool isConst)
 {
+	std::string key;
+	if (IsMerging() || IsTagging())
+		key = GetGlobalVariableKey(propName, ns, propTypeID, isConst);
+	if (IsMerging() && IsWritten(key))
+		return;
+
 	// Write the property
 	BeginNamespace(ns);
 
 	//TODO: Set description for global properties (they don't have an asITypeInfo object)
 	//WriteHeader(type->GetUserData(AS_DOCS_USERDATA_DESC));
+	WriteAvailability(key);
+	WriteTagAnchor(key);
 
 	m_stream << GetIndent();
 	if (isConst)
 		m_stream << "const ";
 	m_stream << GetTypeName(propTypeID);
 	m_stream << " " << propName << ";" << std::endl;
+
+	if (IsTagging())
+		AddTagGlobal(ns, nullptr, GetTagMember("variable", (isConst ? "const " : "") + GetTypeName(propTypeID), propName, GetTagScopeFile(ns, nullptr), key, ""));
 }
 
 void ScriptDocs::WriteHeader(void* p, bool member)
@@ -537,18 +1754,53 @@ void ScriptDocs::WriteHeader(void* p, bool member)
 	}
 }
 
+void ScriptDocs::WriteFunctionHeader(asIScriptFunction* func, bool member)
+{
+	void* userData = func->GetUserData(AS_DOCS_USERDATA);
+	if (userData != nullptr)
+	{
+		WriteHeader(userData, member);
+		return;
+	}
+
+	// Script functions don't have metadata, but they might have a comment in front of them
+	const char* section = nullptr;
+	int row = 0;
+	func->GetDeclaredAt(&section, &row, nullptr);
+
+	ScriptDocsSource* source = GetSource(section);
+	if (source == nullptr)
+	{
+		WriteHeader(nullptr, member);
+		return;
+	}
+
+	ScriptDocsMetadata meta;
+	meta.m_description = source->GetCommentBefore(row);
+	WriteHeader(meta.m_description != "" ? &meta : nullptr, member);
+}
+
+ScriptDocsSource* ScriptDocs::GetSource(const char* section)
+{
+	if (section == nullptr || section[0] == '\0')
+		return nullptr;
+
+	// Every section is only mapped and indexed once
+	auto it = m_sources.find(section);
+	if (it == m_sources.end())
+		it = m_sources.emplace(section, std::unique_ptr<ScriptDocsSource>(new ScriptDocsSource(section))).first;
+
+	if (it->second->m_data == nullptr)
+		return nullptr;
+	return it->second.get();
+}
+
 void ScriptDocs::WriteFunction(asIScriptFunction* func, bool astypedef)
 {
 	// Get info about the function
-	asDWORD dwReturnTypeFlags;
-	int funcReturnTypeID = func->GetReturnTypeId(&dwReturnTypeFlags);
-
-	// Get the visibility
-	MemberVisibility vis = MV_Public;
-	if (func->IsPrivate()) vis = MV_Private;
-	else if (func->IsProtected()) vis = MV_Protected;
+	int funcReturnTypeID = func->GetReturnTypeId();
 
-	WriteVisibility(vis);
+	WriteVisibility(GetVisibility(func));
 
 	// Special case: explicit and implicit casting has a different syntax in C++.
 	//TODO: This duplicates if both opConv and opCast are set (but why would you want to have both?)
@@ -567,12 +1819,7 @@ void ScriptDocs::WriteFunction(asIScriptFunction* func, bool astypedef)
 	if (astypedef)
 		m_stream << "typedef ";
 
-	if (dwReturnTypeFlags & asTYPEID_OBJHANDLE)
-		m_stream << GetTypeName(funcReturnTypeID) << "*";
-	else if (dwReturnTypeFlags & asTYPEID_HANDLETOCONST)
-		m_stream << "const " << GetTypeName(funcReturnTypeID) << "*";
-	else
-		m_stream << GetTypeName(funcReturnTypeID);
+	m_stream << GetReturnTypeName(func);
 
 	// Get name info
 	MethodTrait trait = MT_Normal;
@@ -589,87 +1836,633 @@ void ScriptDocs::WriteFunction(asIScriptFunction* func, bool astypedef)
 	else
 		m_stream << " " << funcName << "(";
 
-	// Get parameter count
-	int nParams = func->GetParamCount();
+	m_stream << GetParamList(func, trait, true);
+	m_stream << ");" << std::endl;
+}
 
-	// Special case: For methods marked with arithmatic trait, we need to add the "this" parameter.
-	// string operator+(string, float); // MT_Arithmatic
-	// string operator+(float, string); // MT_Arithmatic_r
-	if (trait == MT_Arithmetic)
+MemberVisibility ScriptDocs::GetVisibility(asIScriptFunction* func)
+{
+	if (func->IsPrivate()) return MV_Private;
+	if (func->IsProtected()) return MV_Protected;
+	return MV_Public;
+}
+
+void ScriptDocs::WriteVisibility(MemberVisibility vis)
+{
+	if (vis != m_lastVis)
 	{
-		auto typeObject = func->GetObjectType();
-		if (typeObject != nullptr)
+		m_lastVis = vis;
+		switch (vis)
 		{
-			m_stream << GetTypeName(typeObject->GetTypeId());
-			if (nParams > 0)
-				m_stream << ", ";
+		case MV_Public: m_stream << GetIndent(-1) << "public:"; break;
+		case MV_Private: m_stream << GetIndent(-1) << "private:"; break;
+		case MV_Protected: m_stream << GetIndent(-1) << "protected:"; break;
 		}
+		m_stream << std::endl;
 	}
+}
 
-	// For each function parameter
+void ScriptDocs::WriteAvailability(const std::string &key, const std::string &parentKey)
+{
+	if (key == "")
+		return;
+
+	auto it = m_availability.find(key);
+	if (it == m_availability.end())
+		return;
+
+	// Members only need a tag when they're not available everywhere their class is
+	if (parentKey != "")
+	{
+		auto itParent = m_availability.find(parentKey);
+		if (itParent != m_availability.end() && itParent->second == it->second)
+			return;
+	}
+
+	m_stream << GetIndent() << "//! \\remark Available in: " << GetEngineNames(it->second) << std::endl;
+}
+
+std::string ScriptDocs::GetEngineNames(unsigned long long mask)
+{
+	std::string engines;
+	for (size_t i = 0; i < m_engineNames.size(); i++)
+	{
+		if (!(mask & (1ULL << i)))
+			continue;
+		if (engines != "")
+			engines += ", ";
+		engines += m_engineNames[i];
+	}
+	return engines;
+}
+
+void ScriptDocs::WriteInstantiations(asITypeInfo* type)
+{
+	auto it = m_templateInstances.find(GetTemplateKey(type));
+	if (it == m_templateInstances.end())
+		return;
+
+	// When an instance stands in for its template, it's the first one in the list
+	size_t first = (IsTemplateInstance(type) ? 1 : 0);
+	if (first >= it->second.size())
+		return;
+
+	m_stream << GetIndent() << "//! \\remark Instantiations: ";
+	for (size_t i = first; i < it->second.size(); i++)
+	{
+		m_stream << it->second[i];
+		if (i + 1 < it->second.size())
+			m_stream << ", ";
+	}
+	m_stream << std::endl;
+}
+
+int ScriptDocs::GetCopyCost(int typeID)
+{
+	// Primitives and handles are cheap to copy
+	if (typeID <= asTYPEID_DOUBLE || (typeID & asTYPEID_OBJHANDLE))
+		return 0;
+
+	asITypeInfo* type = m_writeEngine->GetTypeInfoById(typeID);
+	if (type == nullptr || !(type->GetFlags() & asOBJ_VALUE))
+		return 0;
+
+	// Anything that fits in a couple of registers is fine
+	int size = type->GetSize();
+	if (size <= (int)(2 * sizeof(void*)))
+		return 0;
+
+	// Non-POD types also go through their copy constructor and destructor
+	if (!(type->GetFlags() & asOBJ_POD))
+		size += 64;
+	return size;
+}
+
+std::string ScriptDocs::GetAuditAvailability(const std::string &key)
+{
+	if (!IsMerging())
+		return "";
+
+	auto it = m_availability.find(key);
+	if (it == m_availability.end())
+		return "";
+	return " [" + GetEngineNames(it->second) + "]";
+}
+
+void ScriptDocs::AddAuditItem(int cost, const std::string &decl, const std::string &issue)
+{
+	m_audit.push_back(std::make_tuple(cost, decl, issue));
+}
+
+void ScriptDocs::AuditFunction(asIScriptFunction* func)
+{
+	std::string decl = func->GetDeclaration(true, true, true) + GetAuditAvailability(GetFunctionKey(func));
+
+	// Large value types returned by value
+	asDWORD returnFlags;
+	int returnTypeID = func->GetReturnTypeId(&returnFlags);
+	int returnCost = GetCopyCost(returnTypeID);
+	if (returnCost > 0 && !(returnFlags & asTM_INOUTREF))
+	{
+		std::string typeName = GetTypeName(returnTypeID);
+		AddAuditItem(returnCost, decl, "Returns " + typeName + " by value (" + std::to_string(m_writeEngine->GetTypeInfoById(returnTypeID)->GetSize()) +
+			" bytes); return a const " + typeName + " & if the value outlives the call");
+	}
+
+	// Handles returned where a reference would do
+	if (returnTypeID & asTYPEID_OBJHANDLE)
+	{
+		asITypeInfo* type = m_writeEngine->GetTypeInfoById(returnTypeID);
+		if (type != nullptr && (type->GetFlags() & asOBJ_REF) && !(type->GetFlags() & asOBJ_NOCOUNT))
+		{
+			AddAuditItem(24, decl, std::string("Returns a handle to ") + type->GetName() +
+				", which costs an AddRef and Release per call; return a reference if it can never be null");
+		}
+	}
+
+	// Large value types passed by value
+	int nParams = func->GetParamCount();
 	for (int i = 0; i < nParams; i++)
 	{
-		// Get info about the parameter
 		const char* paramName;
-		const char* paramDefault;
 		int paramTypeID;
 		asDWORD paramFlags;
-		func->GetParam(i, &paramTypeID, &paramFlags, &paramName, &paramDefault);
+		func->GetParam(i, &paramTypeID, &paramFlags, &paramName);
 
-		// Write the parameter to file
-		if (paramFlags & asTM_CONST)
-			m_stream << "const ";
-		m_stream << GetTypeName(paramTypeID);
-		if (paramFlags & asTM_INOUTREF)
-			m_stream << "&";
+		int paramCost = GetCopyCost(paramTypeID);
+		if (paramCost == 0 || (paramFlags & asTM_INOUTREF))
+			continue;
 
-		if (paramName != nullptr && strlen(paramName) > 0)
-			m_stream << " " << paramName;
+		std::string typeName = GetTypeName(paramTypeID);
+		std::string param = (paramName != nullptr && paramName[0] != '\0' ? std::string(" '") + paramName + "'" : std::string(""));
+		AddAuditItem(paramCost, decl, "Takes " + typeName + param + " by value (" + std::to_string(m_writeEngine->GetTypeInfoById(paramTypeID)->GetSize()) +
+			" bytes); pass it as const " + typeName + " &in");
+	}
+
+	// Virtual properties
+	std::string funcName = func->GetName();
+	if (funcName.compare(0, 4, "get_") == 0 || funcName.compare(0, 4, "set_") == 0)
+	{
+		AddAuditItem(8, decl, "Property accessor, so every access is a function call; register it with " +
+			std::string(func->GetObjectType() != nullptr ? "RegisterObjectProperty" : "RegisterGlobalProperty") + " if it maps directly to a variable");
+	}
+}
+
+void ScriptDocs::AuditOperators(asITypeInfo* type)
+{
+	bool hasCmp = false, hasEquals = false, hasAssign = false;
+
+	int nMethods = type->GetMethodCount();
+	for (int i = 0; i < nMethods; i++)
+	{
+		std::string funcName = type->GetMethodByIndex(i)->GetName();
+		if (funcName == "opCmp") hasCmp = true;
+		else if (funcName == "opEquals") hasEquals = true;
+		else if (funcName == "opAssign") hasAssign = true;
+	}
+
+	std::string typeName = GetTemplateKey(type) + GetAuditAvailability(GetTypeKey(type));
+
+	// Without opEquals, == and != are compiled into an opCmp call and a comparison of its result
+	if (hasCmp && !hasEquals)
+		AddAuditItem(16, typeName, "Has opCmp but no opEquals, so == and != fall back to a full opCmp; register opEquals");
+
+	// The engine copies POD types with a plain memory copy, unless an opAssign is registered
+	if ((type->GetFlags() & asOBJ_VALUE) && (type->GetFlags() & asOBJ_POD) && hasAssign)
+		AddAuditItem(16, typeName, "POD type with opAssign, which replaces the engine's memory copy with a function call; remove opAssign");
+}
+
+bool ScriptDocs::IsTagging()
+{
+	return m_tagStream.is_open();
+}
+
+void ScriptDocs::BeginTagFile(const char* headerFilename)
+{
+	m_tagNamespaces.clear();
+	m_tagGroups.clear();
+
+	// The global scope ends up on the page of the header itself
+	m_tagHeader = headerFilename;
+	size_t sep = m_tagHeader.find_last_of("/\\");
+	if (sep != std::string::npos)
+		m_tagHeader = m_tagHeader.substr(sep + 1);
+
+	m_tagStream.open(m_tagFilename, std::ofstream::out);
+	m_tagStream << "<?xml version='1.0' encoding='UTF-8' standalone='yes' ?>" << std::endl;
+	m_tagStream << "<tagfile>" << std::endl;
+}
+
+void ScriptDocs::EndTagFile()
+{
+	for (auto &it : m_tagNamespaces)
+	{
+		if (it.first == "")
+			continue;
+
+		m_tagStream << "  <compound kind=\"namespace\">" << std::endl;
+		m_tagStream << "    <name>" << xmlEscape(it.first) << "</name>" << std::endl;
+		m_tagStream << "    <filename>namespace" << doxygenEscape(it.first, m_tagCaseSensitive) << ".html</filename>" << std::endl;
+		m_tagStream << it.second;
+		m_tagStream << "  </compound>" << std::endl;
+	}
+
+	m_tagStream << "  <compound kind=\"file\">" << std::endl;
+	m_tagStream << "    <name>" << xmlEscape(m_tagHeader) << "</name>" << std::endl;
+	m_tagStream << "    <path></path>" << std::endl;
+	m_tagStream << "    <filename>" << doxygenEscape(m_tagHeader, m_tagCaseSensitive) << ".html</filename>" << std::endl;
+	m_tagStream << m_tagNamespaces[""];
+	m_tagStream << "  </compound>" << std::endl;
+
+	for (auto &it : m_tagGroups)
+	{
+		m_tagStream << "  <compound kind=\"group\">" << std::endl;
+		m_tagStream << "    <name>" << xmlEscape(it.first) << "</name>" << std::endl;
+		m_tagStream << "    <title>" << xmlEscape(it.first) << "</title>" << std::endl;
+		m_tagStream << "    <filename>group__" << doxygenEscape(it.first, m_tagCaseSensitive) << ".html</filename>" << std::endl;
+		m_tagStream << it.second;
+		m_tagStream << "  </compound>" << std::endl;
+	}
+
+	m_tagStream << "</tagfile>" << std::endl;
+	m_tagStream.close();
+}
+
+std::string ScriptDocs::GetTagName(asITypeInfo* type)
+{
+	std::string ret = (IsTemplateInstance(type) ? doxygenTemplateName(GetTypeName(type->GetTypeId())) : type->GetName());
+
+	const char* ns = type->GetNamespace();
+	if (ns != nullptr && ns[0] != '\0')
+		ret = std::string(ns) + "::" + ret;
+	return ret;
+}
+
+std::string ScriptDocs::GetTagAnchor(const std::string &key)
+{
+	unsigned long long hash = hashString(key.c_str());
+
+	static const char* digits = "0123456789abcdef";
+	std::string ret = "a";
+	for (int i = 60; i >= 0; i -= 4)
+		ret += digits[(hash >> i) & 0xF];
+	return ret;
+}
+
+void ScriptDocs::WriteTagAnchor(const std::string &key)
+{
+	// Doxygen makes up its own anchors for members, so give it the ones from the tag file
+	if (IsTagging())
+		m_stream << GetIndent() << "//! \\anchor " << GetTagAnchor(key) << std::endl;
+}
+
+std::string ScriptDocs::GetTagScopeFile(const char* ns, void* userData)
+{
+	// Grouped declarations are documented on the group's page
+	ScriptDocsMetadata* meta = (ScriptDocsMetadata*)userData;
+	if (meta != nullptr && meta->m_group != "")
+		return "group__" + doxygenEscape(meta->m_group, m_tagCaseSensitive) + ".html";
+
+	if (ns == nullptr || ns[0] == '\0')
+		return doxygenEscape(m_tagHeader, m_tagCaseSensitive) + ".html";
+	return "namespace" + doxygenEscape(ns, m_tagCaseSensitive) + ".html";
+}
+
+std::string &ScriptDocs::GetTagScope(const std::string &ns)
+{
+	auto it = m_tagNamespaces.find(ns);
+	if (it != m_tagNamespaces.end())
+		return it->second;
+
+	// List new namespaces in their parent scope
+	if (ns != "")
+	{
+		size_t sep = ns.rfind("::");
+		GetTagScope(sep == std::string::npos ? "" : ns.substr(0, sep)) += "    <namespace>" + xmlEscape(ns) + "</namespace>\n";
+	}
+	return m_tagNamespaces[ns];
+}
+
+std::string ScriptDocs::GetTagMember(const char* kind, const std::string &type, const std::string &name, const std::string &anchorFile, const std::string &key, const std::string &args, const std::string &extra)
+{
+	std::string ret = std::string("    <member kind=\"") + kind + "\">\n";
+	ret += "      <type>" + xmlEscape(type) + "</type>\n";
+	ret += "      <name>" + xmlEscape(name) + "</name>\n";
+	ret += "      <anchorfile>" + anchorFile + "</anchorfile>\n";
+	ret += "      <anchor>" + GetTagAnchor(key) + "</anchor>\n";
+	ret += "      <arglist>" + xmlEscape(args) + "</arglist>\n";
+	ret += extra;
+	ret += "    </member>\n";
+	return ret;
+}
+
+std::string ScriptDocs::GetTagFunction(asIScriptFunction* func, const std::string &anchorFile, const std::string &key)
+{
+	// Casts are named after the type they convert to, like in WriteFunction
+	std::string funcName = func->GetName();
+	if (funcName == "opCast" || funcName == "opConv" || funcName == "opImplCast" || funcName == "opImplConv")
+		return GetTagMember("function", "", "operator " + GetTypeName(func->GetReturnTypeId()), anchorFile, key, "()");
+
+	auto funcNameInfo = GetFunctionName(funcName);
+	std::string name = std::get<0>(funcNameInfo);
+	MethodTrait trait = std::get<1>(funcNameInfo);
+
+	std::string args = "(" + GetParamList(func, trait, false) + ")";
+	if (func->IsReadOnly())
+		args += " const";
+
+	return GetTagMember("function", GetReturnTypeName(func), name, anchorFile, key, args);
+}
 
-		if (paramDefault != nullptr)
+std::string ScriptDocs::AddTagClass(asITypeInfo* type)
+{
+	std::string name = GetTagName(type);
+	std::string ref = "    <class kind=\"class\">" + xmlEscape(name) + "</class>\n";
+
+	const char* ns = type->GetNamespace();
+	GetTagScope(ns == nullptr ? "" : ns) += ref;
+
+	ScriptDocsMetadata* meta = (ScriptDocsMetadata*)type->GetUserData(AS_DOCS_USERDATA);
+	if (meta != nullptr && meta->m_group != "")
+		m_tagGroups[meta->m_group] += ref;
+
+	return "class" + doxygenEscape(name, m_tagCaseSensitive) + ".html";
+}
+
+void ScriptDocs::AddTagGlobal(const char* ns, void* userData, const std::string &member)
+{
+	GetTagScope(ns == nullptr ? "" : ns) += member;
+
+	ScriptDocsMetadata* meta = (ScriptDocsMetadata*)userData;
+	if (meta != nullptr && meta->m_group != "")
+		m_tagGroups[meta->m_group] += member;
+}
+
+void ScriptDocs::WriteTagClass(asITypeInfo* type, const std::string &filename, const std::string &members)
+{
+	m_tagStream << "  <compound kind=\"class\">" << std::endl;
+	m_tagStream << "    <name>" << xmlEscape(GetTagName(type)) << "</name>" << std::endl;
+	m_tagStream << "    <filename>" << filename << "</filename>" << std::endl;
+
+	if (!IsTemplateInstance(type))
+	{
+		int nSubTypes = type->GetSubTypeCount();
+		for (int i = 0; i < nSubTypes; i++)
+			m_tagStream << "    <templarg>class " << xmlEscape(type->GetSubType(i)->GetName()) << "</templarg>" << std::endl;
+	}
+
+	asITypeInfo* baseType = type->GetBaseType();
+	if (baseType != nullptr)
+		m_tagStream << "    <base>" << xmlEscape(GetTagName(baseType)) << "</base>" << std::endl;
+
+	int nInterfaces = type->GetInterfaceCount();
+	for (int i = 0; i < nInterfaces; i++)
+		m_tagStream << "    <base>" << xmlEscape(GetTagName(type->GetInterface(i))) << "</base>" << std::endl;
+
+	m_tagStream << members;
+	m_tagStream << "  </compound>" << std::endl;
+}
+
+void ScriptDocs::ScanByteCode(asIScriptFunction* func, std::vector<asIScriptFunction*> &scan)
+{
+	asUINT length;
+	asDWORD* bc = func->GetByteCode(&length);
+	if (bc == nullptr)
+		return;
+
+	asIScriptEngine* engine = func->GetEngine();
+	asDWORD* end = bc + length;
+	while (bc < end)
+	{
+		asEBCInstr op = asEBCInstr(*(asBYTE*)bc);
+		switch (op)
 		{
-			// Angelscript returns this to us in space-delimited keywords, eg: "- 1", "vec2 ( 0 , 0 )", "Foo :: Bar"
-			if (paramTypeID == m_stringType->GetTypeId())
-				m_stream << " = " << paramDefault;
-			else
-			{
-				// Remove spaces
-				std::string strParamDefault(paramDefault);
-				strParamDefault.erase(std::remove_if(strParamDefault.begin(), strParamDefault.end(), ::isspace), strParamDefault.end());
-				m_stream << " = " << strParamDefault;
-			}
+		// Function calls
+		case asBC_CALL:
+		case asBC_CALLSYS:
+		case asBC_CALLINTF:
+		case asBC_Thiscall1:
+			AddFunctionReference(engine->GetFunctionById(asBC_INTARG(bc)), scan);
+			break;
+
+		// Object allocation, followed by the constructor call
+		case asBC_ALLOC:
+			AddFunctionReference(engine->GetFunctionById(*(int*)(bc + 1 + sizeof(asPWORD) / sizeof(asDWORD))), scan);
+			break;
+
+		// Function pointers (callbacks, delegates and lambdas)
+		case asBC_FuncPtr:
+			AddFunctionReference((asIScriptFunction*)asBC_PTRARG(bc), scan);
+			break;
+
+		// Global property access, by address
+		case asBC_PGA:
+		case asBC_PshGPtr:
+		case asBC_LDG:
+		case asBC_PshG4:
+		case asBC_LdGRdR4:
+		case asBC_CpyVtoG4:
+		case asBC_CpyGtoV4:
+		case asBC_SetG4:
+			m_usedGlobals.insert((const void*)asBC_PTRARG(bc));
+			break;
+
+		// Object property access, by type and offset
+		case asBC_ADDSi:
+		case asBC_LoadThisR:
+			AddPropertyReference(engine, asBC_INTARG(bc), asBC_SWORDARG0(bc));
+			break;
+		case asBC_LoadRObjR:
+		case asBC_LoadVObjR:
+			AddPropertyReference(engine, *(int*)(bc + 2), asBC_SWORDARG1(bc));
+			break;
+
+		default:
+			break;
 		}
 
-		// Maybe another parameter
-		if (i + 1 < nParams)
-			m_stream << ", ";
+		bc += asBCTypeSize[asBCInfo[op].type];
 	}
+}
 
-	if (trait == MT_Arithmetic_r)
+void ScriptDocs::AddFunctionReference(asIScriptFunction* func, std::vector<asIScriptFunction*> &scan)
+{
+	if (func == nullptr)
+		return;
+
+	m_usedFunctions.insert(func->GetId());
+
+	asITypeInfo* type = func->GetObjectType();
+	if (type != nullptr && type->GetSubTypeCount() > 0)
+		m_usedTemplateMethods.insert(GetTemplateKey(type) + "::" + func->GetName());
+
+	if (func->GetFuncType() == asFUNC_SCRIPT)
+		scan.push_back(func);
+}
+
+void ScriptDocs::AddPropertyReference(asIScriptEngine* engine, int typeID, int offset)
+{
+	// The bytecode has the type of the accessed object, while inherited properties are declared by one of its base types
+	asITypeInfo* type = engine->GetTypeInfoById(typeID);
+	if (type == nullptr)
 	{
-		auto typeObject = func->GetObjectType();
-		if (typeObject != nullptr)
+		m_usedProperties.insert(((unsigned long long)(unsigned int)typeID << 32) | (unsigned int)offset);
+		return;
+	}
+
+	if (type->GetSubTypeCount() > 0)
+		m_usedTemplateProperties.insert(GetTemplateKey(type) + "::" + std::to_string(offset));
+
+	for (; type != nullptr; type = type->GetBaseType())
+		m_usedProperties.insert(((unsigned long long)(unsigned int)type->GetTypeId() << 32) | (unsigned int)offset);
+}
+
+ScriptDocsSource::ScriptDocsSource(const char* filename)
+{
+#ifdef _WIN32
+	m_file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (m_file == INVALID_HANDLE_VALUE)
+	{
+		m_file = nullptr;
+		return;
+	}
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(m_file, &size) || size.QuadPart == 0)
+		return;
+
+	m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (m_mapping == nullptr)
+		return;
+
+	m_data = (const char*)MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+	if (m_data == nullptr)
+		return;
+	m_size = (size_t)size.QuadPart;
+#else
+	int fd = open(filename, O_RDONLY);
+	if (fd == -1)
+		return;
+
+	struct stat st;
+	if (fstat(fd, &st) == 0 && st.st_size > 0)
+	{
+		void* data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (data != MAP_FAILED)
 		{
-			if (nParams > 0)
-				m_stream << ", ";
-			m_stream << GetTypeName(typeObject->GetTypeId());
+			m_data = (const char*)data;
+			m_size = st.st_size;
 		}
 	}
 
-	m_stream << ");" << std::endl;
+	// The mapping stays valid after the file is closed
+	close(fd);
+	if (m_data == nullptr)
+		return;
+#endif
+
+	// Index where each line starts, so rows can be looked up directly
+	m_lines.push_back(0);
+	const char* p = m_data;
+	const char* end = m_data + m_size;
+	while ((p = (const char*)memchr(p, '\n', end - p)) != nullptr)
+		m_lines.push_back(++p - m_data);
 }
 
-void ScriptDocs::WriteVisibility(MemberVisibility vis)
+ScriptDocsSource::~ScriptDocsSource()
 {
-	if (vis != m_lastVis)
+#ifdef _WIN32
+	if (m_data != nullptr)
+		UnmapViewOfFile(m_data);
+	if (m_mapping != nullptr)
+		CloseHandle(m_mapping);
+	if (m_file != nullptr)
+		CloseHandle(m_file);
+#else
+	if (m_data != nullptr)
+		munmap((void*)m_data, m_size);
+#endif
+}
+
+std::string ScriptDocsSource::GetLine(int row)
+{
+	// Rows start at 1, and we leave out surrounding whitespace
+	const char* begin = m_data + m_lines[row - 1];
+	const char* end = ((size_t)row < m_lines.size() ? m_data + m_lines[row] : m_data + m_size);
+	while (begin < end && ::isspace((unsigned char)*begin))
+		begin++;
+	while (end > begin && ::isspace((unsigned char)*(end - 1)))
+		end--;
+	return std::string(begin, end);
+}
+
+std::string ScriptDocsSource::GetCommentBefore(int row)
+{
+	// Walk upwards from the declaration for as long as there are comment lines
+	std::vector<std::string> lines;
+	bool inBlock = false;
+	size_t blockEnd = 0;
+	for (int i = row - 1; i >= 1 && (size_t)i <= m_lines.size(); i--)
 	{
-		m_lastVis = vis;
-		switch (vis)
+		std::string line = GetLine(i);
+		bool blockStart = false;
+
+		if (!inBlock && line.compare(0, 2, "//") == 0)
 		{
-		case MV_Public: m_stream << GetIndent(-1) << "public:"; break;
-		case MV_Private: m_stream << GetIndent(-1) << "private:"; break;
-		case MV_Protected: m_stream << GetIndent(-1) << "protected:"; break;
+			// "//", "///" and "//!" comments
+			line.erase(0, 2);
+			if (line.size() > 0 && (line[0] == '/' || line[0] == '!'))
+				line.erase(0, 1);
 		}
-		m_stream << std::endl;
+		else if (inBlock || (line.size() >= 2 && line.compare(line.size() - 2, 2, "*/") == 0))
+		{
+			// "/* */", "/** */" and "/*! */" comments
+			if (!inBlock)
+			{
+				line.erase(line.size() - 2);
+				blockEnd = lines.size();
+			}
+			inBlock = true;
+
+			size_t start = line.find("/*");
+			if (start != std::string::npos)
+			{
+				// A block that follows code on the same line (eg: "int x = 3; /* note */") isn't documentation
+				if (start != 0)
+				{
+					lines.resize(blockEnd);
+					break;
+				}
+				line.erase(0, start + 2);
+				blockStart = true;
+			}
+			if (line.size() > 0 && (line[0] == '*' || line[0] == '!'))
+				line.erase(0, 1);
+		}
+		else
+			break;
+
+		if (line.size() > 0 && line[0] == ' ')
+			line.erase(0, 1);
+		while (line.size() > 0 && ::isspace((unsigned char)line[line.size() - 1]))
+			line.erase(line.size() - 1);
+		lines.push_back(line);
+
+		if (blockStart)
+			break;
 	}
+
+	// Lines were gathered bottom to top, and we don't want the empty lines around the text
+	std::string ret;
+	for (auto it = lines.rbegin(); it != lines.rend(); it++)
+	{
+		if (ret == "" && *it == "")
+			continue;
+		if (ret != "")
+			ret += "\n";
+		ret += *it;
+	}
+	while (ret.size() > 0 && ret[ret.size() - 1] == '\n')
+		ret.erase(ret.size() - 1);
+	return ret;
 }
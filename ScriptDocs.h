@@ -7,12 +7,25 @@
 #include <fstream>
 #include <tuple>
 #include <algorithm>
+#include <unordered_set>
+#include <unordered_map>
+#include <map>
+#include <memory>
+#include <functional>
+#include <cstring>
+#include <cassert>
 
 class asIScriptEngine;
 class asIScriptModule;
 class asIScriptFunction;
 class asITypeInfo;
 
+class ScriptDocsMetadata;
+class ScriptDocsSource;
+
+// Return false to leave the declaration out of the docs. Metadata is null when the declaration has none.
+typedef std::function<bool(const char* ns, const char* name, ScriptDocsMetadata* meta)> ScriptDocsFilter;
+
 enum MemberVisibility
 {
 	MV_None,
@@ -28,6 +41,29 @@ enum MethodTrait
 	MT_Arithmetic_r,
 };
 
+enum SymbolKind
+{
+	SK_Type,
+	SK_Function,
+	SK_Property,
+	SK_GlobalProperty,
+	SK_EnumValue,
+};
+
+class ScriptDocsSymbol
+{
+public:
+	std::string m_name;
+	SymbolKind m_kind;
+	asIScriptEngine* m_engine;
+	asITypeInfo* m_type;
+	std::vector<asIScriptFunction*> m_functions;
+	int m_index;
+
+	std::string m_rendered;
+	bool m_isRendered = false;
+};
+
 class ScriptDocs
 {
 public:
@@ -35,10 +71,44 @@ public:
 	std::ofstream m_stream;
 
 public:
-	ScriptDocs(asIScriptEngine* engine);
+	ScriptDocs(asIScriptEngine* engine, const char* name = nullptr);
 	~ScriptDocs();
+
+	// Adds another engine to document alongside the first one (up to 64). Declarations shared by several
+	// engines are only written once, tagged with the names of the engines they're available in. Returns false if
+	// there are already 64 engines.
+	bool AddEngine(asIScriptEngine* engine, const char* name = nullptr);
+
+	// Limits which top-level declarations get written. Each kind of filter only applies once it's been used, and a
+	// declaration has to pass all of them. Namespaces include their nested namespaces, and name patterns are matched
+	// against the full name ("Namespace::Name") with '*' and '?' wildcards.
+	void IncludeNamespace(const char* ns);
+	void ExcludeNamespace(const char* ns);
+	void IncludeGroup(const char* group);
+	void ExcludeGroup(const char* group);
+	void IncludeName(const char* pattern);
+	void ExcludeName(const char* pattern);
+	void SetFilter(const ScriptDocsFilter &filter);
+
+	// Makes Write also produce a Doxygen tag file for the engine docs, so other Doxygen projects can link to
+	// the script API without running Doxygen on the generated header. caseSensitiveNames has to match the
+	// CASE_SENSE_NAMES setting of the Doxygen run on the header, since it changes the names of the pages.
+	void SetTagFile(const char* filename, bool caseSensitiveNames = true);
+
 	void Write(const char* filename, bool scripts = false);
 
+	// Lists registered functions, methods and properties that no compiled script function references, for each engine
+	void WriteUnusedReport(const char* filename);
+
+	// Lists registrations that are likely to slow down script calls, most expensive first
+	void WriteAudit(const char* filename);
+
+	// Builds an index of all symbols by their fully qualified name (eg. "Namespace::Class::Method"), which can then
+	// be looked up with Lookup. The documentation of a symbol is written to buffer, cut off to fit if needed. Only
+	// the first lookup of each symbol renders it, after that it's a hash lookup and a copy.
+	void BuildIndex();
+	bool Lookup(const char* name, char* buffer, size_t size);
+
 private:
 	MemberVisibility m_lastVis;
 	asITypeInfo* m_stringType;
@@ -47,14 +117,74 @@ private:
 	std::string m_lastName;
 	std::string m_lastGroup;
 
+	std::vector<asIScriptEngine*> m_engines;
+	std::vector<std::string> m_engineNames;
+	asIScriptEngine* m_writeEngine;
+	std::unordered_map<std::string, unsigned long long> m_availability;
+	std::unordered_map<std::string, std::vector<asITypeInfo*>> m_typeVariants;
+	std::unordered_set<std::string> m_written;
+	std::unordered_map<std::string, asITypeInfo*> m_templateTypes;
+	std::unordered_map<std::string, std::vector<std::string>> m_templateInstances;
+
+	std::vector<std::string> m_includeNamespaces;
+	std::vector<std::string> m_excludeNamespaces;
+	std::vector<std::string> m_includeGroups;
+	std::vector<std::string> m_excludeGroups;
+	std::vector<std::string> m_includeNames;
+	std::vector<std::string> m_excludeNames;
+	ScriptDocsFilter m_filter;
+
+	std::string m_tagFilename;
+	bool m_tagCaseSensitive = true;
+	std::string m_tagHeader;
+	std::ofstream m_tagStream;
+	std::map<std::string, std::string> m_tagNamespaces;
+	std::map<std::string, std::string> m_tagGroups;
+
+	std::unordered_map<std::string, std::unique_ptr<ScriptDocsSource>> m_sources;
+
+	std::vector<ScriptDocsSymbol> m_symbols;
+	std::unordered_multimap<unsigned long long, size_t> m_symbolIndex;
+
+	std::unordered_set<int> m_usedFunctions;
+	std::unordered_set<std::string> m_usedTemplateMethods;
+	std::unordered_set<std::string> m_usedTemplateProperties;
+	std::unordered_set<const void*> m_usedGlobals;
+	std::unordered_set<unsigned long long> m_usedProperties;
+
+	std::vector<std::tuple<int, std::string, std::string>> m_audit;
+
 private:
 	void WriteFor(asIScriptEngine* engine);
 	void WriteFor(asIScriptModule* mod);
+	void Prepare();
+	void GatherFor(asIScriptEngine* engine, unsigned long long mask);
+	void GatherTemplates(asIScriptEngine* engine);
+	void SetWriteEngine(asIScriptEngine* engine);
+	bool IsFiltered(asITypeInfo* type);
+	bool IsFiltered(asIScriptFunction* func);
+	bool IsFiltered(const char* ns, const char* name, void* userData);
+	bool IsMerging();
+	bool IsWritten(const std::string &key);
+
+	std::string GetTypeKey(asITypeInfo* type);
+	std::string GetFuncdefKey(asITypeInfo* funcdefType);
+	std::string GetFunctionKey(asIScriptFunction* func);
+	std::string GetPropertyKey(asITypeInfo* type, int index);
+	std::string GetEnumValueKey(asITypeInfo* enumType, int index);
+	std::string GetGlobalVariableKey(const char* propName, const char* ns, int propTypeID, bool isConst);
+	std::vector<asITypeInfo*> GetTypeVariants(asITypeInfo* type, const std::string &key);
+
+	std::string GetTemplateKey(asITypeInfo* type);
+	bool IsTemplateInstance(asITypeInfo* type);
+	bool IsFoldedInstance(asITypeInfo* type);
 
 	void BeginNamespace(const char* ns);
 	std::string GetIndent(int offset = 0);
 	std::string GetTypeName(int typeID);
 
+	std::string GetReturnTypeName(asIScriptFunction* func);
+	std::string GetParamList(asIScriptFunction* func, MethodTrait trait, bool defaults);
 	std::tuple<const char*, MethodTrait> GetFunctionName(const std::string &name);
 
 	void WriteClass(asITypeInfo* type);
@@ -64,8 +194,43 @@ private:
 	void WriteGlobalVariable(const char* propName, const char* ns, int propTypeID, bool isConst);
 
 	void WriteHeader(void* p, bool member);
+	void WriteFunctionHeader(asIScriptFunction* func, bool member);
+	ScriptDocsSource* GetSource(const char* section);
 	void WriteFunction(asIScriptFunction* func, bool astypedef = false);
+	MemberVisibility GetVisibility(asIScriptFunction* func);
 	void WriteVisibility(MemberVisibility vis);
+	void WriteAvailability(const std::string &key, const std::string &parentKey = "");
+	std::string GetEngineNames(unsigned long long mask);
+	void WriteInstantiations(asITypeInfo* type);
+
+	int GetCopyCost(int typeID);
+	std::string GetAuditAvailability(const std::string &key);
+	void AddAuditItem(int cost, const std::string &decl, const std::string &issue);
+	void AuditFunction(asIScriptFunction* func);
+	void AuditOperators(asITypeInfo* type);
+
+	ScriptDocsSymbol* FindSymbol(const char* name);
+	void AddSymbol(const std::string &name, SymbolKind kind, asIScriptEngine* engine, asITypeInfo* type, asIScriptFunction* func, int index);
+	void RenderSymbol(ScriptDocsSymbol &symbol);
+
+	bool IsTagging();
+	void BeginTagFile(const char* headerFilename);
+	void EndTagFile();
+	std::string GetTagName(asITypeInfo* type);
+	std::string GetTagAnchor(const std::string &key);
+	void WriteTagAnchor(const std::string &key);
+	std::string GetTagScopeFile(const char* ns, void* userData);
+	std::string &GetTagScope(const std::string &ns);
+	std::string GetTagMember(const char* kind, const std::string &type, const std::string &name, const std::string &anchorFile, const std::string &key, const std::string &args, const std::string &extra = "");
+	std::string GetTagFunction(asIScriptFunction* func, const std::string &anchorFile, const std::string &key);
+	std::string AddTagClass(asITypeInfo* type);
+	void AddTagGlobal(const char* ns, void* userData, const std::string &member);
+	void WriteTagClass(asITypeInfo* type, const std::string &filename, const std::string &members);
+
+	void WriteUnusedFor(asIScriptEngine* engine);
+	void ScanByteCode(asIScriptFunction* func, std::vector<asIScriptFunction*> &scan);
+	void AddFunctionReference(asIScriptFunction* func, std::vector<asIScriptFunction*> &scan);
+	void AddPropertyReference(asIScriptEngine* engine, int typeID, int offset);
 };
 
 class ScriptDocsMetadata
@@ -77,6 +242,28 @@ public:
 	bool m_isMember = false;
 };
 
+// A memory-mapped script section, used to find the doc comments in front of script declarations
+class ScriptDocsSource
+{
+public:
+	const char* m_data = nullptr;
+	size_t m_size = 0;
+	std::vector<size_t> m_lines;
+
+private:
+	void* m_file = nullptr;
+	void* m_mapping = nullptr;
+
+public:
+	ScriptDocsSource(const char* filename);
+	~ScriptDocsSource();
+
+	std::string GetCommentBefore(int row);
+
+private:
+	std::string GetLine(int row);
+};
+
 #define AS_DOCS_USERDATA 100
 
 //TODO: Make these macros less big